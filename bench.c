@@ -0,0 +1,667 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "s21_matrix.h"
+
+// Every case runs one call per repetition until MIN_SECONDS have passed.
+// Results the call creates are removed inside the timed loop, so ns/op is
+// the full cost of using the function once.
+#define MIN_SECONDS 0.2
+#define MIN_N 2
+#define MAX_N 4096
+#define MAX_SIZES 12
+// Batch cases treat A's n * n elements as n * n / 16 matrices of 4 x 4.
+#define BATCH_ORDER 4
+// Sparse cases use a five-point operator of order n: the unknowns of a
+// grid about sqrt(n) wide, so rows hold at most this many nonzeros.
+#define SPARSE_STENCIL 5
+// File cases save A here once per size and map it back per call.
+#define BENCH_FILE "bench_matrix.bin"
+// Out-of-core cases work on files through tiles of this order.
+#define BENCH_RESULT "bench_result.bin"
+#define BENCH_TILE 256
+
+typedef struct context_struct {
+  int n;
+  matrix_t A;
+  matrix_t B;
+  matrix_t R;
+  matrix_t S;
+  matrix_t L;
+  s21_lu_t lu;
+  s21_view_t a_view;
+  s21_view_t b_view;
+  s21_batch_t batch;
+  s21_batch_t batch_r;
+  s21_sparse_t sparse;
+  s21_sparse_lu_t sparse_lu;
+  matrix_t V;
+  matrix_f_t A_f;
+  matrix_f_t B_f;
+} context_t;
+
+typedef struct bench_case_struct {
+  const char *name;
+  int max_n;
+  double (*flops)(int n);
+  void (*run)(context_t *ctx);
+} bench_case_t;
+
+typedef struct result_struct {
+  const char *name;
+  int n;
+  long reps;
+  double ns_per_op;
+  double gflops;
+  double allocs_per_call;
+  double bytes_per_call;
+} result_t;
+
+static long alloc_calls = 0;
+static long alloc_bytes = 0;
+
+static double now(void);
+static void *counting_alloc(void *ctx, size_t size, size_t align);
+static void counting_free(void *ctx, void *ptr);
+static int setup(context_t *ctx, int n);
+static int setup_sparse(context_t *ctx, int n);
+static void teardown(context_t *ctx);
+static result_t measure(const bench_case_t *c, context_t *ctx);
+static void print_csv(FILE *f, const result_t *r, int count);
+static void print_json(FILE *f, const result_t *r, int count);
+
+static double flops_none(int n) {
+  (void)n;
+  return 0;
+}
+static double flops_n2(int n) { return (double)n * n; }
+static double flops_mult(int n) { return 2.0 * n * n * n; }
+static double flops_lu(int n) { return 2.0 / 3 * n * n * n; }
+static double flops_inverse(int n) { return 2.0 * n * n * n; }
+static double flops_lu_inverse(int n) { return 4.0 / 3 * n * n * n; }
+static double flops_complements(int n) {
+  return flops_lu(n) + flops_inverse(n);
+}
+static double flops_cholesky(int n) { return 1.0 / 3 * n * n * n; }
+static double flops_solve(int n) { return flops_lu(n) + flops_mult(n); }
+static double flops_batch_lu(int n) {
+  return n * n / (BATCH_ORDER * BATCH_ORDER) * flops_lu(BATCH_ORDER);
+}
+static double flops_batch_inverse(int n) {
+  return n * n / (BATCH_ORDER * BATCH_ORDER) * flops_inverse(BATCH_ORDER);
+}
+static double flops_sparse_mult(int n) {
+  return 2.0 * SPARSE_STENCIL * n * n;
+}
+static double flops_batch_mult(int n) {
+  return n * n / (BATCH_ORDER * BATCH_ORDER) * flops_mult(BATCH_ORDER);
+}
+
+static void run_create(context_t *ctx) {
+  matrix_t r;
+  s21_create_matrix(ctx->n, ctx->n, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_create_aligned(context_t *ctx) {
+  matrix_t r;
+  s21_create_matrix_aligned(ctx->n, ctx->n, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_eq(context_t *ctx) { s21_eq_matrix(&ctx->A, &ctx->A); }
+
+static void run_save_matrix(context_t *ctx) {
+  s21_save_matrix(&ctx->A, BENCH_FILE);
+}
+
+// Maps and unmaps without touching the data: the load itself.
+static void run_mmap_matrix(context_t *ctx) {
+  matrix_t r;
+  (void)ctx;
+  s21_mmap_matrix(BENCH_FILE, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_tiled_mult(context_t *ctx) {
+  s21_tiled_t a, r;
+  s21_tiled_open(BENCH_FILE, &a);
+  s21_tiled_create(BENCH_RESULT, ctx->n, ctx->n, &r);
+  s21_tiled_mult(&a, &a, &r, BENCH_TILE);
+  s21_tiled_close(&a);
+  s21_tiled_close(&r);
+}
+
+// The factorization is in place, so A is saved again first; that costs
+// n * n against the n * n * n of the factorization.
+static void run_tiled_lu(context_t *ctx) {
+  s21_tiled_t a;
+  int *p = malloc(ctx->n * sizeof(int)), singular = 0;
+  s21_save_matrix(&ctx->A, BENCH_RESULT);
+  s21_tiled_open(BENCH_RESULT, &a);
+  s21_tiled_lu(&a, BENCH_TILE, p, &singular);
+  s21_tiled_close(&a);
+  free(p);
+}
+
+static void run_sum(context_t *ctx) {
+  matrix_t r;
+  s21_sum_matrix(&ctx->A, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_sub(context_t *ctx) {
+  matrix_t r;
+  s21_sub_matrix(&ctx->A, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_mult_number(context_t *ctx) {
+  matrix_t r;
+  s21_mult_number(&ctx->A, 1.5, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_mult_matrix(context_t *ctx) {
+  matrix_t r;
+  s21_mult_matrix(&ctx->A, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_sum_into(context_t *ctx) {
+  s21_sum_matrix_into(&ctx->A, &ctx->B, &ctx->R);
+}
+
+static void run_sub_into(context_t *ctx) {
+  s21_sub_matrix_into(&ctx->A, &ctx->B, &ctx->R);
+}
+
+static void run_mult_number_into(context_t *ctx) {
+  s21_mult_number_into(&ctx->A, 1.5, &ctx->R);
+}
+
+static void run_mult_matrix_into(context_t *ctx) {
+  s21_mult_matrix_into(&ctx->A, &ctx->B, &ctx->R);
+}
+
+static void run_sum_inplace(context_t *ctx) {
+  s21_sum_inplace(&ctx->R, &ctx->B);
+}
+
+static void run_sub_inplace(context_t *ctx) {
+  s21_sub_inplace(&ctx->R, &ctx->B);
+}
+
+static void run_mult_number_inplace(context_t *ctx) {
+  s21_mult_number_inplace(&ctx->R, 1.0);
+}
+
+static void run_gemm(context_t *ctx) {
+  s21_gemm(1.0, &ctx->A, &ctx->B, 0.5, &ctx->R);
+}
+
+static void run_axpby(context_t *ctx) {
+  s21_axpby(0.5, &ctx->B, 0.5, &ctx->R);
+}
+
+static void run_transpose(context_t *ctx) {
+  matrix_t r;
+  s21_transpose(&ctx->A, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_transpose_into(context_t *ctx) {
+  s21_transpose_into(&ctx->A, &ctx->R);
+}
+
+static void run_transpose_inplace(context_t *ctx) {
+  s21_transpose_inplace(&ctx->R);
+}
+
+static void run_calc_complements(context_t *ctx) {
+  matrix_t r;
+  s21_calc_complements(&ctx->A, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_determinant(context_t *ctx) {
+  double det;
+  s21_determinant(&ctx->A, &det);
+}
+
+static void run_inverse(context_t *ctx) {
+  matrix_t r;
+  s21_inverse_matrix(&ctx->A, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_lu_factor(context_t *ctx) {
+  s21_lu_t lu;
+  s21_lu_factor(&ctx->A, &lu);
+  s21_lu_remove(&lu);
+}
+
+static void run_lu_solve(context_t *ctx) {
+  matrix_t r;
+  s21_lu_solve(&ctx->lu, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_solve(context_t *ctx) {
+  matrix_t r;
+  s21_solve(&ctx->A, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_mult_matrix_f(context_t *ctx) {
+  matrix_f_t r;
+  s21_mult_matrix_f(&ctx->A_f, &ctx->B_f, &r);
+  s21_remove_matrix_f(&r);
+}
+
+static void run_lu_factor_f(context_t *ctx) {
+  s21_lu_f_t lu;
+  s21_lu_factor_f(&ctx->A_f, &lu);
+  s21_lu_remove_f(&lu);
+}
+
+// One right-hand side, where refinement pays: each step costs n * n.
+static void run_solve_mixed(context_t *ctx) {
+  matrix_t r;
+  s21_solve_mixed(&ctx->A, &ctx->V, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_cholesky(context_t *ctx) {
+  matrix_t r;
+  s21_cholesky(&ctx->S, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_cholesky_solve(context_t *ctx) {
+  matrix_t r;
+  s21_cholesky_solve(&ctx->L, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_sparse_mult_dense(context_t *ctx) {
+  matrix_t r;
+  s21_sparse_mult_dense(&ctx->sparse, &ctx->B, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_sparse_lu_factor(context_t *ctx) {
+  s21_sparse_lu_t lu;
+  s21_sparse_lu_factor(&ctx->sparse, &lu);
+  s21_sparse_lu_remove(&lu);
+}
+
+static void run_sparse_lu_solve(context_t *ctx) {
+  matrix_t r;
+  s21_sparse_lu_solve(&ctx->sparse_lu, &ctx->V, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_determinant_spd(context_t *ctx) {
+  double det;
+  s21_determinant(&ctx->S, &det);
+}
+
+static void run_inverse_spd(context_t *ctx) {
+  matrix_t r;
+  s21_inverse_matrix(&ctx->S, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_lu_det(context_t *ctx) {
+  double det;
+  s21_lu_det(&ctx->lu, &det);
+}
+
+static void run_lu_inverse(context_t *ctx) {
+  matrix_t r;
+  s21_lu_inverse(&ctx->lu, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_view_copy(context_t *ctx) {
+  matrix_t r;
+  s21_view_copy(&ctx->a_view, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_eq_view(context_t *ctx) {
+  s21_eq_view(&ctx->a_view, &ctx->a_view);
+}
+
+static void run_sum_view(context_t *ctx) {
+  matrix_t r;
+  s21_sum_view(&ctx->a_view, &ctx->b_view, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_sub_view(context_t *ctx) {
+  matrix_t r;
+  s21_sub_view(&ctx->a_view, &ctx->b_view, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_mult_number_view(context_t *ctx) {
+  matrix_t r;
+  s21_mult_number_view(&ctx->a_view, 1.5, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_mult_matrix_view(context_t *ctx) {
+  matrix_t r;
+  s21_mult_matrix_view(&ctx->a_view, &ctx->b_view, &r);
+  s21_remove_matrix(&r);
+}
+
+static void run_determinant_view(context_t *ctx) {
+  double det;
+  s21_determinant_view(&ctx->a_view, &det);
+}
+
+static void run_fast_eq(context_t *ctx) { s21_fast_eq(&ctx->A, &ctx->A); }
+
+static void run_fast_sum(context_t *ctx) {
+  s21_fast_sum(&ctx->A, &ctx->B, &ctx->R);
+}
+
+static void run_fast_mult_number(context_t *ctx) {
+  s21_fast_mult_number(&ctx->A, 1.5, &ctx->R);
+}
+
+static void run_fast_mult_matrix(context_t *ctx) {
+  s21_fast_mult_matrix(&ctx->A, &ctx->B, &ctx->R);
+}
+
+static void run_fast_transpose(context_t *ctx) {
+  s21_fast_transpose(&ctx->A, &ctx->R);
+}
+
+static void run_batch_determinant(context_t *ctx) {
+  s21_batch_determinant(&ctx->batch, ctx->R.data);
+}
+
+static void run_batch_inverse(context_t *ctx) {
+  s21_batch_inverse(&ctx->batch, &ctx->batch_r);
+}
+
+static void run_batch_mult(context_t *ctx) {
+  s21_batch_mult(&ctx->batch, &ctx->batch, &ctx->batch_r);
+}
+
+// The view cases read A through a transposed view, the slowest layout.
+static const bench_case_t cases[] = {
+    {"create_matrix", MAX_N, flops_none, run_create},
+    {"create_matrix_aligned", MAX_N, flops_none, run_create_aligned},
+    {"eq_matrix", MAX_N, flops_n2, run_eq},
+    {"save_matrix", MAX_N, flops_none, run_save_matrix},
+    {"mmap_matrix", MAX_N, flops_none, run_mmap_matrix},
+    {"tiled_mult", MAX_N, flops_mult, run_tiled_mult},
+    {"tiled_lu", MAX_N, flops_lu, run_tiled_lu},
+    {"sum_matrix", MAX_N, flops_n2, run_sum},
+    {"sub_matrix", MAX_N, flops_n2, run_sub},
+    {"mult_number", MAX_N, flops_n2, run_mult_number},
+    {"mult_matrix", MAX_N, flops_mult, run_mult_matrix},
+    {"sum_matrix_into", MAX_N, flops_n2, run_sum_into},
+    {"sub_matrix_into", MAX_N, flops_n2, run_sub_into},
+    {"mult_number_into", MAX_N, flops_n2, run_mult_number_into},
+    {"mult_matrix_into", MAX_N, flops_mult, run_mult_matrix_into},
+    {"sum_inplace", MAX_N, flops_n2, run_sum_inplace},
+    {"sub_inplace", MAX_N, flops_n2, run_sub_inplace},
+    {"mult_number_inplace", MAX_N, flops_n2, run_mult_number_inplace},
+    {"gemm", MAX_N, flops_mult, run_gemm},
+    {"axpby", MAX_N, flops_n2, run_axpby},
+    {"transpose", MAX_N, flops_none, run_transpose},
+    {"transpose_into", MAX_N, flops_none, run_transpose_into},
+    {"transpose_inplace", MAX_N, flops_none, run_transpose_inplace},
+    {"calc_complements", MAX_N, flops_complements, run_calc_complements},
+    {"determinant", MAX_N, flops_lu, run_determinant},
+    {"inverse_matrix", MAX_N, flops_inverse, run_inverse},
+    {"lu_factor", MAX_N, flops_lu, run_lu_factor},
+    {"lu_solve", MAX_N, flops_mult, run_lu_solve},
+    {"solve", MAX_N, flops_solve, run_solve},
+    {"mult_matrix_f", MAX_N, flops_mult, run_mult_matrix_f},
+    {"lu_factor_f", MAX_N, flops_lu, run_lu_factor_f},
+    {"solve_mixed", MAX_N, flops_lu, run_solve_mixed},
+    {"cholesky", MAX_N, flops_cholesky, run_cholesky},
+    {"cholesky_solve", MAX_N, flops_mult, run_cholesky_solve},
+    {"sparse_mult_dense", MAX_N, flops_sparse_mult, run_sparse_mult_dense},
+    {"sparse_lu_factor", MAX_N, flops_none, run_sparse_lu_factor},
+    {"sparse_lu_solve", MAX_N, flops_none, run_sparse_lu_solve},
+    {"determinant_spd", MAX_N, flops_cholesky, run_determinant_spd},
+    {"inverse_spd", MAX_N, flops_inverse, run_inverse_spd},
+    {"lu_det", MAX_N, flops_none, run_lu_det},
+    {"lu_inverse", MAX_N, flops_lu_inverse, run_lu_inverse},
+    {"view_copy", MAX_N, flops_none, run_view_copy},
+    {"eq_view", MAX_N, flops_n2, run_eq_view},
+    {"sum_view", MAX_N, flops_n2, run_sum_view},
+    {"sub_view", MAX_N, flops_n2, run_sub_view},
+    {"mult_number_view", MAX_N, flops_n2, run_mult_number_view},
+    {"mult_matrix_view", MAX_N, flops_mult, run_mult_matrix_view},
+    {"determinant_view", MAX_N, flops_lu, run_determinant_view},
+    {"fast_eq", MAX_N, flops_n2, run_fast_eq},
+    {"fast_sum", MAX_N, flops_n2, run_fast_sum},
+    {"fast_mult_number", MAX_N, flops_n2, run_fast_mult_number},
+    {"fast_mult_matrix", MAX_N, flops_mult, run_fast_mult_matrix},
+    {"fast_transpose", MAX_N, flops_none, run_fast_transpose},
+    {"batch_determinant", MAX_N, flops_batch_lu, run_batch_determinant},
+    {"batch_inverse", MAX_N, flops_batch_inverse, run_batch_inverse},
+    {"batch_mult", MAX_N, flops_batch_mult, run_batch_mult},
+};
+
+// Usage: bench [--max N] [--only NAME] [--csv FILE] [--json FILE]
+int main(int argc, char **argv) {
+  int max_n = MAX_N, count = 0, error = 0;
+  const char *only = NULL, *csv = NULL, *json = NULL;
+  int case_count = sizeof(cases) / sizeof(cases[0]);
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--max")) {
+      max_n = atoi(argv[i + 1]);
+    } else if (!strcmp(argv[i], "--only")) {
+      only = argv[i + 1];
+    } else if (!strcmp(argv[i], "--csv")) {
+      csv = argv[i + 1];
+    } else if (!strcmp(argv[i], "--json")) {
+      json = argv[i + 1];
+    }
+  }
+  s21_allocator_t counting = {counting_alloc, counting_free, NULL};
+  s21_set_allocator(&counting);
+  max_n = max_n < MAX_N ? max_n : MAX_N;
+  result_t *results = malloc(case_count * MAX_SIZES * sizeof(result_t));
+  error = !results;
+  printf("%-24s %6s %10s %14s %10s %10s %14s\n", "op", "n", "reps", "ns/op",
+         "GFLOP/s", "allocs", "bytes");
+  for (int n = MIN_N; n <= max_n && !error; n *= 2) {
+    context_t ctx;
+    error = setup(&ctx, n);
+    for (int c = 0; c < case_count && !error; c++) {
+      if (n <= cases[c].max_n && (!only || !strcmp(only, cases[c].name))) {
+        result_t *r = &results[count++];
+        *r = measure(&cases[c], &ctx);
+        printf("%-24s %6d %10ld %14.1f %10.3f %10.1f %14.0f\n", r->name,
+               r->n, r->reps, r->ns_per_op, r->gflops, r->allocs_per_call,
+               r->bytes_per_call);
+        fflush(stdout);
+      }
+    }
+    teardown(&ctx);
+  }
+  FILE *f = csv ? fopen(csv, "w") : NULL;
+  if (f) {
+    print_csv(f, results, count);
+    fclose(f);
+  }
+  f = json ? fopen(json, "w") : NULL;
+  if (f) {
+    print_json(f, results, count);
+    fclose(f);
+  }
+  free(results);
+  if (error) {
+    fprintf(stderr, "bench: out of memory\n");
+  }
+  return error;
+}
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void *counting_alloc(void *ctx, size_t size, size_t align) {
+  (void)ctx;
+  alloc_calls++;
+  alloc_bytes += size;
+  return align <= sizeof(double) ? malloc(size)
+                                 : aligned_alloc(align, (size + align - 1) /
+                                                            align * align);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+  (void)ctx;
+  free(ptr);
+}
+
+// A is diagonally dominant so that every factorization is well defined.
+static int setup(context_t *ctx, int n) {
+  int error = 0;
+  ctx->n = n;
+  error = s21_create_matrix(n, n, &ctx->A) ||
+          s21_create_matrix(n, n, &ctx->B) ||
+          s21_create_matrix(n, n, &ctx->R) ||
+          s21_create_matrix(n, n, &ctx->S);
+  for (int i = 0; i < n && !error; i++) {
+    for (int j = 0; j < n; j++) {
+      ctx->A.matrix[i][j] = (i * 7 + j * 3) % 11 / 11.0 + (i == j) * n;
+      ctx->B.matrix[i][j] = (i * 5 + j) % 13 / 13.0;
+      ctx->S.matrix[i][j] = (i * j) % 11 / 11.0 + (i == j) * n;
+    }
+  }
+  if (!error) {
+    error = s21_lu_factor(&ctx->A, &ctx->lu) ||
+            s21_cholesky(&ctx->S, &ctx->L) ||
+            s21_view_matrix(&ctx->A, &ctx->a_view) ||
+            s21_view_matrix(&ctx->B, &ctx->b_view);
+    s21_view_transpose(&ctx->a_view);
+  }
+  if (!error) {
+    int size = BATCH_ORDER * BATCH_ORDER, count = n * n / size;
+    s21_batch_t batch = {ctx->A.data, count, BATCH_ORDER, BATCH_ORDER, size,
+                         ctx->A.allocator};
+    ctx->batch = batch;
+    ctx->batch_r = batch;
+    ctx->batch_r.data = ctx->R.data;
+  }
+  if (!error) {
+    error = setup_sparse(ctx, n) || s21_save_matrix(&ctx->A, BENCH_FILE) ||
+            s21_to_float(&ctx->A, &ctx->A_f) ||
+            s21_to_float(&ctx->B, &ctx->B_f);
+  }
+  return error;
+}
+
+// The operator of test_sparse_lu on a k x k grid padded to n unknowns, with
+// a right-hand side V of one column.
+static int setup_sparse(context_t *ctx, int n) {
+  int k = 1, count = 0;
+  while ((k + 1) * (k + 1) <= n) {
+    k++;
+  }
+  int *row = malloc(SPARSE_STENCIL * n * sizeof(int));
+  int *column = malloc(SPARSE_STENCIL * n * sizeof(int));
+  double *value = malloc(SPARSE_STENCIL * n * sizeof(double));
+  int error = !row || !column || !value;
+  for (int v = 0; v < n && !error; v++) {
+    int neighbour[] = {v - k, v + k, v - 1, v + 1};
+    double weight[] = {-1.2, -0.8, -1.1, -0.9};
+    row[count] = v;
+    column[count] = v;
+    value[count++] = 4.5;
+    for (int d = 0; d < 4; d++) {
+      if (neighbour[d] >= 0 && neighbour[d] < n) {
+        row[count] = v;
+        column[count] = neighbour[d];
+        value[count++] = weight[d];
+      }
+    }
+  }
+  if (!error) {
+    error = s21_sparse_from_triplets(n, n, count, row, column, value,
+                                     &ctx->sparse) ||
+            s21_sparse_lu_factor(&ctx->sparse, &ctx->sparse_lu) ||
+            s21_create_matrix(n, 1, &ctx->V);
+  }
+  for (int v = 0; v < n && !error; v++) {
+    ctx->V.matrix[v][0] = v % 5 - 2;
+  }
+  free(row);
+  free(column);
+  free(value);
+  return error;
+}
+
+static void teardown(context_t *ctx) {
+  s21_remove_matrix(&ctx->A);
+  s21_remove_matrix(&ctx->B);
+  s21_remove_matrix(&ctx->R);
+  s21_remove_matrix(&ctx->S);
+  s21_remove_matrix(&ctx->L);
+  s21_lu_remove(&ctx->lu);
+  s21_sparse_remove(&ctx->sparse);
+  s21_sparse_lu_remove(&ctx->sparse_lu);
+  s21_remove_matrix(&ctx->V);
+  s21_remove_matrix_f(&ctx->A_f);
+  s21_remove_matrix_f(&ctx->B_f);
+  remove(BENCH_FILE);
+  remove(BENCH_RESULT);
+}
+
+static result_t measure(const bench_case_t *c, context_t *ctx) {
+  result_t r = {c->name, ctx->n, 0, 0, 0, 0, 0};
+  double start = now(), elapsed = 0;
+  alloc_calls = 0;
+  alloc_bytes = 0;
+  while (elapsed < MIN_SECONDS) {
+    c->run(ctx);
+    r.reps++;
+    elapsed = now() - start;
+  }
+  r.ns_per_op = elapsed * 1e9 / r.reps;
+  r.gflops = c->flops(ctx->n) / r.ns_per_op;
+  r.allocs_per_call = (double)alloc_calls / r.reps;
+  r.bytes_per_call = (double)alloc_bytes / r.reps;
+  return r;
+}
+
+static void print_csv(FILE *f, const result_t *r, int count) {
+  fprintf(f, "op,n,reps,ns_per_op,gflops,allocs_per_call,bytes_per_call\n");
+  for (int i = 0; i < count; i++) {
+    fprintf(f, "%s,%d,%ld,%.1f,%.4f,%.2f,%.0f\n", r[i].name, r[i].n,
+            r[i].reps, r[i].ns_per_op, r[i].gflops, r[i].allocs_per_call,
+            r[i].bytes_per_call);
+  }
+}
+
+static void print_json(FILE *f, const result_t *r, int count) {
+  fprintf(f, "[\n");
+  for (int i = 0; i < count; i++) {
+    fprintf(f,
+            "  {\"op\": \"%s\", \"n\": %d, \"reps\": %ld, \"ns_per_op\": %.1f, "
+            "\"gflops\": %.4f, \"allocs_per_call\": %.2f, "
+            "\"bytes_per_call\": %.0f}%s\n",
+            r[i].name, r[i].n, r[i].reps, r[i].ns_per_op, r[i].gflops,
+            r[i].allocs_per_call, r[i].bytes_per_call,
+            i + 1 < count ? "," : "");
+  }
+  fprintf(f, "]\n");
+}
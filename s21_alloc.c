@@ -0,0 +1,93 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "s21_matrix.h"
+
+static void *default_alloc(void *ctx, size_t size, size_t align);
+static void default_free(void *ctx, void *ptr);
+static void *arena_alloc(void *ctx, size_t size, size_t align);
+static void arena_free(void *ctx, void *ptr);
+
+static const s21_allocator_t default_allocator = {default_alloc, default_free,
+                                                  NULL};
+static s21_allocator_t current_allocator = {default_alloc, default_free, NULL};
+
+// Not synchronized: install the allocator before other threads create
+// matrices. NULL restores malloc and free.
+void s21_set_allocator(const s21_allocator_t *allocator) {
+  current_allocator = allocator ? *allocator : default_allocator;
+}
+
+const s21_allocator_t *s21_get_allocator(void) { return &current_allocator; }
+
+int s21_arena_init(s21_arena_t *arena, size_t size) {
+  int error = !arena || !size;
+  if (!error) {
+    arena->base = malloc(size);
+    arena->size = arena->base ? size : 0;
+    arena->used = 0;
+    error = arena->base ? 0 : 1;
+  }
+  return error;
+}
+
+s21_allocator_t s21_arena_allocator(s21_arena_t *arena) {
+  s21_allocator_t allocator = {arena_alloc, arena_free, arena};
+  return allocator;
+}
+
+// Everything handed out since init or the last reset becomes invalid.
+void s21_arena_reset(s21_arena_t *arena) {
+  if (arena) {
+    arena->used = 0;
+  }
+}
+
+void s21_arena_destroy(s21_arena_t *arena) {
+  if (arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+  }
+}
+
+static void *default_alloc(void *ctx, size_t size, size_t align) {
+  void *ptr = NULL;
+  (void)ctx;
+  if (align <= _Alignof(max_align_t)) {
+    ptr = malloc(size);
+  } else {
+    ptr = aligned_alloc(align, (size + align - 1) / align * align);
+  }
+  return ptr;
+}
+
+static void default_free(void *ctx, void *ptr) {
+  (void)ctx;
+  free(ptr);
+}
+
+// Bumps the offset past the aligned block; NULL once the arena is full.
+static void *arena_alloc(void *ctx, size_t size, size_t align) {
+  s21_arena_t *arena = ctx;
+  void *ptr = NULL;
+  if (align < 1) {
+    align = 1;
+  }
+  uintptr_t base = (uintptr_t)arena->base;
+  uintptr_t start = (base + arena->used + align - 1) & ~(uintptr_t)(align - 1);
+  if (arena->base && start - base <= arena->size &&
+      size <= arena->size - (start - base)) {
+    ptr = (void *)start;
+    arena->used = start - base + size;
+  }
+  return ptr;
+}
+
+// Single blocks are never given back; s21_arena_reset frees them all.
+static void arena_free(void *ctx, void *ptr) {
+  (void)ctx;
+  (void)ptr;
+}
@@ -1,30 +1,78 @@
 #include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "s21_matrix.h"
 
 #define EPS 1e-7
 
+// Register tile of the micro-kernel and the cache blocks around it: an
+// MR x KC sliver of A stays in L1, the MC x KC block of A in L2 and the
+// KC x NC panel of B in L3.
+#define GEMM_MR 4
+#define GEMM_NR 8
+#define GEMM_MC 96
+#define GEMM_KC 256
+#define GEMM_NC 2048
+// Below this many multiply-adds packing costs more than it saves.
+#define GEMM_SMALL (32 * 32 * 32)
+// Below this many multiply-adds a product is not worth a thread.
+#define GEMM_PARALLEL (128 * 128 * 128)
+// Smallest number of elements handed to one thread by elementwise ops.
+#define ELEMENTWISE_GRAIN (1 << 15)
+
+enum elementwise_op { OP_EQ, OP_SUM, OP_SUB, OP_MULT_NUMBER, OP_AXPBY };
+
+typedef struct elementwise_struct {
+  int op;
+  const s21_view_t *A;
+  const s21_view_t *B;
+  double number;
+  // OP_AXPBY computes number * A + beta * B.
+  double beta;
+  matrix_t *result;
+  int flat;
+  int dense;
+  atomic_int unequal;
+} elementwise_t;
+
 static int check_eq_dim(matrix_t *A, matrix_t *B);
-static int cycle_eq_matrix(matrix_t *A, matrix_t *B);
-static int cycle_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
-static int cycle_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
-static int cycle_mult_number_matrix(matrix_t *A, double number,
-                                    matrix_t *result);
+static int check_eq_view_dim(s21_view_t *A, s21_view_t *B);
+static int check_into(matrix_t *A, matrix_t *result);
+static void clear_matrix(matrix_t *A);
+static int cycle_elementwise(int op, matrix_t *A, matrix_t *B, double number,
+                             matrix_t *result);
+static int cycle_view_elementwise(int op, const s21_view_t *A,
+                                  const s21_view_t *B, double number,
+                                  matrix_t *result, int flat);
 static int cycle_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
-double calc_mul_elem(matrix_t *A, matrix_t *B, int i, int j);
+static void cycle_axpby(double alpha, matrix_t *X, double beta, matrix_t *Y);
+static int fast_elementwise(int op, matrix_t *A, matrix_t *B, double number,
+                            matrix_t *result);
+static int is_dense(const s21_view_t *view);
+static void elementwise_rows(void *arg, int begin, int end);
+static int elementwise_span(elementwise_t *args,
+                            const simd_kernels_t *kernels, int i, long n);
+static int elementwise_strided(elementwise_t *args, int i);
+static void gemm_scaled(double alpha, const s21_view_t *a,
+                        const s21_view_t *b, double beta, double **c, int cc);
 
 int s21_eq_matrix(matrix_t *A, matrix_t *B) {
+  STATS_BEGIN(S21_STAT_EQ);
   int error = check_bad_matrix(A) || check_bad_matrix(B);
   if (!error) {
     error = check_eq_dim(A, B);
   }
   if (!error) {
-    error = cycle_eq_matrix(A, B);
+    error = cycle_elementwise(OP_EQ, A, B, 0, NULL);
   }
+  STATS_END(S21_STAT_EQ, error ? 0 : (double)A->rows * A->columns);
   return error ? FAILURE : SUCCESS;
 }
 
 int s21_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUM);
   int error = check_bad_matrix(A) || check_bad_matrix(B);
   if (!error) {
     error = check_eq_dim(A, B);
@@ -33,12 +81,14 @@ int s21_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
     error = s21_create_matrix(A->rows, A->columns, result);
   }
   if (!error) {
-    error = cycle_sum_matrix(A, B, result);
+    error = cycle_elementwise(OP_SUM, A, B, 0, result);
   }
+  STATS_END(S21_STAT_SUM, error ? 0 : (double)A->rows * A->columns);
   return error;
 }
 
 int s21_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUB);
   int error = check_bad_matrix(A) || check_bad_matrix(B);
   if (!error) {
     error = check_eq_dim(A, B);
@@ -47,23 +97,27 @@ int s21_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
     error = s21_create_matrix(A->rows, A->columns, result);
   }
   if (!error) {
-    error = cycle_sub_matrix(A, B, result);
+    error = cycle_elementwise(OP_SUB, A, B, 0, result);
   }
+  STATS_END(S21_STAT_SUB, error ? 0 : (double)A->rows * A->columns);
   return error;
 }
 
 int s21_mult_number(matrix_t *A, double number, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_NUMBER);
   int error = check_bad_matrix(A);
   if (!error) {
     error = s21_create_matrix(A->rows, A->columns, result);
   }
   if (!error) {
-    error = cycle_mult_number_matrix(A, number, result);
+    error = cycle_elementwise(OP_MULT_NUMBER, A, NULL, number, result);
   }
+  STATS_END(S21_STAT_MULT_NUMBER, error ? 0 : (double)A->rows * A->columns);
   return error;
 }
 
 int s21_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
   int error = check_bad_matrix(A) || check_bad_matrix(B);
   if (!error) {
     if (A->columns != B->rows) {
@@ -71,101 +125,405 @@ int s21_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
     }
   }
   if (!error) {
-    error = s21_create_matrix(A->rows, A->rows, result);
+    error = s21_create_matrix(A->rows, B->columns, result);
   }
   if (!error) {
     error = cycle_mult_matrix(A, B, result);
   }
+  STATS_END(S21_STAT_MULT_MATRIX,
+            error ? 0 : 2.0 * A->rows * A->columns * B->columns);
   return error;
 }
 
-static int check_eq_dim(matrix_t *A, matrix_t *B) {
-  int error = 0;
-  if ((A->rows != B->rows) || (A->columns != B->columns)) {
-    error = 2;
+int s21_sum_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUM);
+  int error = check_bad_matrix(B);
+  if (!error) {
+    error = check_into(A, result);
   }
+  if (!error) {
+    error = check_eq_dim(A, B);
+  }
+  if (!error) {
+    error = cycle_elementwise(OP_SUM, A, B, 0, result);
+  }
+  STATS_END(S21_STAT_SUM, error ? 0 : (double)A->rows * A->columns);
   return error;
 }
 
-static int cycle_eq_matrix(matrix_t *A, matrix_t *B) {
-  int error = 0;
-  for (int i = 0; i < A->rows && !error; i++) {
-    if (!(A->matrix[i]) || !(B->matrix[i])) {
-      error = 1;
-    }
-    for (int j = 0; j < A->columns && !error; j++) {
-      if (fabs(A->matrix[i][j] - B->matrix[i][j]) > EPS) {
-        error = 1;
-      }
-    }
+int s21_sub_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUB);
+  int error = check_bad_matrix(B);
+  if (!error) {
+    error = check_into(A, result);
+  }
+  if (!error) {
+    error = check_eq_dim(A, B);
+  }
+  if (!error) {
+    error = cycle_elementwise(OP_SUB, A, B, 0, result);
   }
+  STATS_END(S21_STAT_SUB, error ? 0 : (double)A->rows * A->columns);
   return error;
 }
 
-static int cycle_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
-  int error = 0;
-  for (int i = 0; i < A->rows && !error; i++) {
-    if (!(A->matrix[i]) || !(B->matrix[i])) {
-      error = 1;
-    }
-    for (int j = 0; j < A->columns && !error; j++) {
-      result->matrix[i][j] = A->matrix[i][j] + B->matrix[i][j];
+int s21_mult_number_into(matrix_t *A, double number, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_NUMBER);
+  int error = check_into(A, result);
+  if (!error) {
+    error = cycle_elementwise(OP_MULT_NUMBER, A, NULL, number, result);
+  }
+  STATS_END(S21_STAT_MULT_NUMBER, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_mult_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
+  int error =
+      check_bad_matrix(A) || check_bad_matrix(B) || check_bad_matrix(result);
+  if (!error) {
+    if (A->columns != B->rows || result->rows != A->rows ||
+        result->columns != B->columns) {
+      error = 2;
     }
   }
+  if (!error) {
+    error = check_aliasing(A, result) || check_aliasing(B, result) ? 2 : 0;
+  }
+  if (!error) {
+    error = cycle_mult_matrix(A, B, result);
+  }
+  STATS_END(S21_STAT_MULT_MATRIX,
+            error ? 0 : 2.0 * A->rows * A->columns * B->columns);
   return error;
 }
 
-static int cycle_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
-  int error = 0;
-  for (int i = 0; i < A->rows && !error; i++) {
-    if (!(A->matrix[i]) || !(B->matrix[i])) {
-      error = 1;
+int s21_gemm(double alpha, matrix_t *A, matrix_t *B, double beta,
+             matrix_t *C) {
+  STATS_BEGIN(S21_STAT_GEMM);
+  int error = check_bad_matrix(A) || check_bad_matrix(B) || check_bad_matrix(C);
+  if (!error) {
+    if (A->columns != B->rows || C->rows != A->rows ||
+        C->columns != B->columns) {
+      error = 2;
     }
-    for (int j = 0; j < A->columns && !error; j++) {
-      result->matrix[i][j] = A->matrix[i][j] - B->matrix[i][j];
+  }
+  if (!error) {
+    error = check_aliasing(A, C) || check_aliasing(B, C) ? 2 : 0;
+  }
+  if (!error && alpha == 0 && beta == 0) {
+    clear_matrix(C);
+  } else if (!error && alpha == 0) {
+    cycle_elementwise(OP_MULT_NUMBER, C, NULL, beta, C);
+  } else if (!error) {
+    s21_view_t a = view_of(A), b = view_of(B);
+    gemm_scaled(alpha, &a, &b, beta, C->matrix, 0);
+  }
+  STATS_END(S21_STAT_GEMM,
+            error ? 0 : 2.0 * A->rows * A->columns * B->columns);
+  return error;
+}
+
+int s21_axpby(double alpha, matrix_t *X, double beta, matrix_t *Y) {
+  STATS_BEGIN(S21_STAT_AXPBY);
+  int error = check_into(X, Y);
+  if (!error) {
+    cycle_axpby(alpha, X, beta, Y);
+  }
+  STATS_END(S21_STAT_AXPBY, error ? 0 : 3.0 * X->rows * X->columns);
+  return error;
+}
+
+int s21_eq_view(s21_view_t *A, s21_view_t *B) {
+  STATS_BEGIN(S21_STAT_EQ);
+  int error = check_bad_view(A) || check_bad_view(B);
+  if (!error) {
+    error = check_eq_view_dim(A, B);
+  }
+  if (!error) {
+    error = cycle_view_elementwise(OP_EQ, A, B, 0, NULL, 0);
+  }
+  STATS_END(S21_STAT_EQ, error ? 0 : (double)A->rows * A->columns);
+  return error ? FAILURE : SUCCESS;
+}
+
+int s21_sum_view(s21_view_t *A, s21_view_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUM);
+  int error = check_bad_view(A) || check_bad_view(B);
+  if (!error) {
+    error = check_eq_view_dim(A, B);
+  }
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->columns, result);
+  }
+  if (!error) {
+    error = cycle_view_elementwise(OP_SUM, A, B, 0, result, 0);
+  }
+  STATS_END(S21_STAT_SUM, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_sub_view(s21_view_t *A, s21_view_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUB);
+  int error = check_bad_view(A) || check_bad_view(B);
+  if (!error) {
+    error = check_eq_view_dim(A, B);
+  }
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->columns, result);
+  }
+  if (!error) {
+    error = cycle_view_elementwise(OP_SUB, A, B, 0, result, 0);
+  }
+  STATS_END(S21_STAT_SUB, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_mult_number_view(s21_view_t *A, double number, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_NUMBER);
+  int error = check_bad_view(A);
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->columns, result);
+  }
+  if (!error) {
+    error = cycle_view_elementwise(OP_MULT_NUMBER, A, NULL, number, result, 0);
+  }
+  STATS_END(S21_STAT_MULT_NUMBER, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_mult_matrix_view(s21_view_t *A, s21_view_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
+  int error = check_bad_view(A) || check_bad_view(B);
+  if (!error) {
+    if (A->columns != B->rows) {
+      error = 2;
     }
   }
+  if (!error) {
+    error = s21_create_matrix(A->rows, B->columns, result);
+  }
+  if (!error) {
+    gemm_update(1, A, B, result->matrix, 0);
+  }
+  STATS_END(S21_STAT_MULT_MATRIX,
+            error ? 0 : 2.0 * A->rows * A->columns * B->columns);
   return error;
 }
 
-static int cycle_mult_number_matrix(matrix_t *A, double number,
-                                    matrix_t *result) {
+int s21_sum_inplace(matrix_t *A, matrix_t *B) {
+  return s21_sum_matrix_into(A, B, A);
+}
+
+int s21_sub_inplace(matrix_t *A, matrix_t *B) {
+  return s21_sub_matrix_into(A, B, A);
+}
+
+int s21_mult_number_inplace(matrix_t *A, double number) {
+  return s21_mult_number_into(A, number, A);
+}
+
+int s21_fast_eq(matrix_t *A, matrix_t *B) {
+  STATS_BEGIN(S21_STAT_EQ);
+  int unequal = fast_elementwise(OP_EQ, A, B, 0, NULL);
+  STATS_END(S21_STAT_EQ, (double)A->rows * A->columns);
+  return unequal ? FAILURE : SUCCESS;
+}
+
+void s21_fast_sum(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUM);
+  fast_elementwise(OP_SUM, A, B, 0, result);
+  STATS_END(S21_STAT_SUM, (double)A->rows * A->columns);
+}
+
+void s21_fast_sub(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SUB);
+  fast_elementwise(OP_SUB, A, B, 0, result);
+  STATS_END(S21_STAT_SUB, (double)A->rows * A->columns);
+}
+
+void s21_fast_mult_number(matrix_t *A, double number, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_NUMBER);
+  fast_elementwise(OP_MULT_NUMBER, A, NULL, number, result);
+  STATS_END(S21_STAT_MULT_NUMBER, (double)A->rows * A->columns);
+}
+
+void s21_fast_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
+  s21_view_t a = view_of(A), b = view_of(B);
+  memset(result->data, 0,
+         (size_t)result->rows * result->ld * sizeof(double));
+  gemm_update(1, &a, &b, result->matrix, 0);
+  STATS_END(S21_STAT_MULT_MATRIX, 2.0 * A->rows * A->columns * B->columns);
+}
+
+static int check_eq_dim(matrix_t *A, matrix_t *B) {
   int error = 0;
-  for (int i = 0; i < A->rows && !error; i++) {
-    if (!(A->matrix[i])) {
-      error = 1;
-    }
-    for (int j = 0; j < A->columns && !error; j++) {
-      result->matrix[i][j] = A->matrix[i][j] * number;
-    }
+  if ((A->rows != B->rows) || (A->columns != B->columns)) {
+    error = 2;
   }
   return error;
 }
 
-static int cycle_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+static int check_eq_view_dim(s21_view_t *A, s21_view_t *B) {
   int error = 0;
-  for (int i = 0; i < A->rows; i++) {
-    if (!(A->matrix[i])) {
-      error = 1;
-    }
+  if ((A->rows != B->rows) || (A->columns != B->columns)) {
+    error = 2;
+  }
+  return error;
+}
+
+// Elementwise results may alias an operand: every element is read before it
+// is written at the same position.
+static int check_into(matrix_t *A, matrix_t *result) {
+  int error = check_bad_matrix(A) || check_bad_matrix(result);
+  if (!error) {
+    error = check_eq_dim(A, result);
   }
-  for (int i = 0; i < B->rows; i++) {
-    if (!(B->matrix[i])) {
-      error = 1;
+  return error;
+}
+
+static void clear_matrix(matrix_t *A) {
+  if (is_contiguous(A)) {
+    memset(A->matrix[0], 0, (size_t)A->rows * A->columns * sizeof(double));
+  } else {
+    for (int i = 0; i < A->rows; i++) {
+      memset(A->matrix[i], 0, A->columns * sizeof(double));
     }
   }
-  for (int i = 0; i < A->rows && !error; i++) {
-    for (int j = 0; j < B->columns; j++) {
-      result->matrix[i][j] = calc_mul_elem(A, B, i, j);
+}
+
+// Rows were already validated by check_bad_matrix, so the loops below carry
+// no pointer checks. When every operand is one contiguous block a chunk of
+// rows is handed to the SIMD kernel as a single flat array.
+static int cycle_elementwise(int op, matrix_t *A, matrix_t *B, double number,
+                             matrix_t *result) {
+  s21_view_t a = view_of(A), b = B ? view_of(B) : a;
+  int flat = is_contiguous(A) && (!B || is_contiguous(B)) &&
+             (!result || is_contiguous(result));
+  return cycle_view_elementwise(op, &a, B ? &b : NULL, number, result, flat);
+}
+
+// Library-made rows are data + i * ld, so ld alone says whether the
+// matrix is one flat block; no row pointer is looked at.
+static int fast_elementwise(int op, matrix_t *A, matrix_t *B, double number,
+                            matrix_t *result) {
+  s21_view_t a = view_of(A), b = B ? view_of(B) : a;
+  int flat = A->ld == A->columns && (!B || B->ld == B->columns) &&
+             (!result || result->ld == result->columns);
+  return cycle_view_elementwise(op, &a, B ? &b : NULL, number, result, flat);
+}
+
+// For OP_EQ the result is 1 if any element differs by more than EPS.
+static int cycle_view_elementwise(int op, const s21_view_t *A,
+                                  const s21_view_t *B, double number,
+                                  matrix_t *result, int flat) {
+  elementwise_t args = {op, A, B, number, 0, result, flat, 0, 0};
+  int grain = ELEMENTWISE_GRAIN / A->columns;
+  args.dense = is_dense(A) && (!B || is_dense(B));
+  parallel_for(A->rows, grain, elementwise_rows, &args);
+  return atomic_load(&args.unequal);
+}
+
+// Rows were already validated by check_bad_matrix. beta = 0 writes result
+// without reading it, so it needs no clearing first.
+static int cycle_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+  s21_view_t a = view_of(A), b = view_of(B);
+  gemm_scaled(1, &a, &b, 0, result->matrix, 0);
+  return 0;
+}
+
+// beta = 0 goes to the scale kernel, so that Y is never read.
+static void cycle_axpby(double alpha, matrix_t *X, double beta, matrix_t *Y) {
+  s21_view_t x = view_of(X), y = view_of(Y);
+  int flat = is_contiguous(X) && is_contiguous(Y);
+  elementwise_t args = {beta == 0 ? OP_MULT_NUMBER : OP_AXPBY,
+                        &x,
+                        &y,
+                        alpha,
+                        beta,
+                        Y,
+                        flat,
+                        1,
+                        0};
+  parallel_for(X->rows, ELEMENTWISE_GRAIN / X->columns, elementwise_rows,
+               &args);
+}
+
+// Rows of a dense view are runs of adjacent elements the kernels can take.
+static int is_dense(const s21_view_t *view) {
+  return !view->transposed && view->column_step == 1;
+}
+
+// Threads comparing for OP_EQ stop at their next block once any of them
+// finds a difference.
+static void elementwise_rows(void *arg, int begin, int end) {
+  elementwise_t *args = arg;
+  const simd_kernels_t *kernels = simd_kernels();
+  int step = args->flat ? end - begin : 1;
+  long n = (long)step * args->A->columns;
+  for (int i = begin; i < end && !atomic_load(&args->unequal); i += step) {
+    int unequal = args->dense ? elementwise_span(args, kernels, i, n)
+                              : elementwise_strided(args, i);
+    if (unequal) {
+      atomic_store(&args->unequal, 1);
     }
   }
-  return error;
 }
 
-double calc_mul_elem(matrix_t *A, matrix_t *B, int i, int j) {
-  double sum = 0;
-  for (int k = 0; k < A->columns; k++) {
-    sum += A->matrix[i][k] * B->matrix[k][j];
+static int elementwise_span(elementwise_t *args,
+                            const simd_kernels_t *kernels, int i, long n) {
+  int unequal = 0;
+  double *a = view_at(args->A, i, 0);
+  double *b = args->B ? view_at(args->B, i, 0) : NULL;
+  double *c = args->result ? args->result->matrix[i] : NULL;
+  if (args->op == OP_EQ) {
+    unequal = kernels->unequal(a, b, n, EPS);
+  } else if (args->op == OP_SUM) {
+    kernels->add(a, b, c, n);
+  } else if (args->op == OP_SUB) {
+    kernels->sub(a, b, c, n);
+  } else if (args->op == OP_AXPBY) {
+    kernels->axpby(args->number, a, args->beta, b, c, n);
+  } else {
+    kernels->scale(a, args->number, c, n);
+  }
+  return unequal;
+}
+
+// Transposed or strided views go element by element.
+static int elementwise_strided(elementwise_t *args, int i) {
+  int unequal = 0;
+  for (int j = 0; j < args->A->columns && !unequal; j++) {
+    double a = *view_at(args->A, i, j);
+    double b = args->B ? *view_at(args->B, i, j) : 0;
+    if (args->op == OP_EQ) {
+      unequal = fabs(a - b) > EPS;
+    } else if (args->op == OP_SUM) {
+      args->result->matrix[i][j] = a + b;
+    } else if (args->op == OP_SUB) {
+      args->result->matrix[i][j] = a - b;
+    } else if (args->op == OP_AXPBY) {
+      args->result->matrix[i][j] = args->number * a + args->beta * b;
+    } else {
+      args->result->matrix[i][j] = a * args->number;
+    }
   }
-  return sum;
-}
\ No newline at end of file
+  return unequal;
+}
+
+// C += alpha * A * B for the m x k view A and the k x n view B into the
+// m x n block of C whose rows start at c[0] + cc.
+void gemm_update(double alpha, const s21_view_t *a, const s21_view_t *b,
+                 double **c, int cc) {
+  gemm_scaled(alpha, a, b, 1, c, cc);
+}
+
+// gemm_scaled and its helpers, shared with the float product.
+#define SCALAR double
+#define SCALAR_NAME(name) name
+#define SCALAR_VIEW s21_view_t
+#define SCALAR_VIEW_AT view_at
+#define SCALAR_VIEW_BLOCK view_block
+#define GEMM_MICRO_KERNEL gemm_4x8
+#include "s21_gemm.inc"
@@ -0,0 +1,260 @@
+#include <math.h>
+
+#include "s21_matrix.h"
+
+// Columns factored per step. The trailing update of a step is one product
+// per block column of the lower triangle, so only half of it is computed.
+#define CHOLESKY_BLOCK 64
+// Smallest number of panel elements handed to one thread.
+#define CHOLESKY_GRAIN (1 << 14)
+
+typedef struct panel_struct {
+  matrix_t *L;
+  int k0;
+  int k1;
+} panel_t;
+
+static int check_bad_factor(matrix_t *L);
+static int is_spd_candidate(matrix_t *A);
+static int factor_diagonal(matrix_t *L, int k0, int k1);
+static void solve_panel(void *arg, int begin, int end);
+static void update_trailing(matrix_t *L, int k0, int k1);
+static void solve_factored(matrix_t *L, matrix_t *X);
+
+int s21_cholesky(matrix_t *A, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_CHOLESKY);
+  int error = check_bad_matrix(A);
+  if (!error) {
+    error = A->rows == A->columns ? 0 : 2;
+  }
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->rows, result);
+  }
+  if (!error) {
+    error = cholesky_factor(A, result);
+    if (error) {
+      s21_remove_matrix(result);
+    }
+  }
+  STATS_END(S21_STAT_CHOLESKY,
+            error ? 0 : 1.0 / 3 * A->rows * A->rows * A->rows);
+  return error;
+}
+
+int s21_cholesky_solve(matrix_t *L, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_CHOLESKY_SOLVE);
+  int error = check_bad_matrix(B);
+  if (!error) {
+    error = check_bad_factor(L);
+  }
+  if (!error && B->rows != L->rows) {
+    error = 2;
+  }
+  if (!error) {
+    error = s21_create_matrix(B->rows, B->columns, result);
+  }
+  if (!error) {
+    for (int i = 0; i < B->rows; i++) {
+      for (int j = 0; j < B->columns; j++) {
+        result->matrix[i][j] = B->matrix[i][j];
+      }
+    }
+    solve_factored(L, result);
+  }
+  STATS_END(S21_STAT_CHOLESKY_SOLVE,
+            error ? 0 : 2.0 * B->rows * B->rows * B->columns);
+  return error;
+}
+
+int s21_cholesky_det(matrix_t *L, double *result) {
+  STATS_BEGIN(S21_STAT_DETERMINANT);
+  int error = check_bad_matrix(L) || !result;
+  if (!error && L->rows != L->columns) {
+    error = 2;
+  }
+  if (!error) {
+    *result = 1;
+    for (int i = 0; i < L->rows; i++) {
+      *result *= L->matrix[i][i] * L->matrix[i][i];
+    }
+  }
+  STATS_END(S21_STAT_DETERMINANT, error ? 0 : L->rows);
+  return error;
+}
+
+int s21_cholesky_inverse(matrix_t *L, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_INVERSE);
+  int error = check_bad_factor(L);
+  if (!error) {
+    error = s21_create_matrix(L->rows, L->rows, result);
+  }
+  if (!error) {
+    for (int i = 0; i < L->rows; i++) {
+      result->matrix[i][i] = 1;
+    }
+    solve_factored(L, result);
+  }
+  STATS_END(S21_STAT_INVERSE,
+            error ? 0 : 2.0 * L->rows * L->rows * L->rows);
+  return error;
+}
+
+// Right-looking blocked factorization into the n x n matrix L. Only the
+// lower triangle of A is read. Returns 2 once a pivot is not positive.
+int cholesky_factor(matrix_t *A, matrix_t *L) {
+  int n = A->rows, error = 0;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j <= i; j++) {
+      L->matrix[i][j] = A->matrix[i][j];
+    }
+  }
+  for (int k0 = 0; k0 < n && !error; k0 += CHOLESKY_BLOCK) {
+    int k1 = k0 + CHOLESKY_BLOCK < n ? k0 + CHOLESKY_BLOCK : n;
+    error = factor_diagonal(L, k0, k1);
+    if (!error && k1 < n) {
+      panel_t args = {L, k0, k1};
+      int grain = CHOLESKY_GRAIN / ((k1 - k0) * (k1 - k0)) + 1;
+      parallel_for(n - k1, grain, solve_panel, &args);
+      update_trailing(L, k0, k1);
+    }
+  }
+  // Trailing updates also write above the diagonal of each block.
+  for (int i = 0; i < n; i++) {
+    for (int j = i + 1; j < n; j++) {
+      L->matrix[i][j] = 0;
+    }
+  }
+  return error;
+}
+
+// The SPD path behind s21_determinant and s21_inverse_matrix. Returns 2
+// without touching the outputs when A is not exactly symmetric with a
+// positive diagonal, or turns out not to be positive definite.
+int spd_determinant(matrix_t *A, double *det) {
+  matrix_t L = {0};
+  int error = is_spd_candidate(A) ? 0 : 2;
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->rows, &L);
+  }
+  if (!error) {
+    error = cholesky_factor(A, &L);
+  }
+  if (!error) {
+    *det = 1;
+    for (int i = 0; i < L.rows; i++) {
+      *det *= L.matrix[i][i] * L.matrix[i][i];
+    }
+  }
+  s21_remove_matrix(&L);
+  return error;
+}
+
+int spd_inverse(matrix_t *A, matrix_t *result) {
+  matrix_t L = {0};
+  int error = is_spd_candidate(A) ? 0 : 2;
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->rows, &L);
+  }
+  if (!error) {
+    error = cholesky_factor(A, &L);
+  }
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->rows, result);
+  }
+  if (!error) {
+    for (int i = 0; i < A->rows; i++) {
+      result->matrix[i][i] = 1;
+    }
+    solve_factored(&L, result);
+  }
+  s21_remove_matrix(&L);
+  return error;
+}
+
+// A factor is square with a nonzero diagonal.
+static int check_bad_factor(matrix_t *L) {
+  int error = check_bad_matrix(L);
+  if (!error && L->rows != L->columns) {
+    error = 2;
+  }
+  for (int i = 0; !error && i < L->rows; i++) {
+    error = L->matrix[i][i] == 0 ? 2 : 0;
+  }
+  return error;
+}
+
+// Exact symmetry and a positive diagonal: necessary for SPD and O(n^2),
+// so most other matrices are turned away before any factoring.
+static int is_spd_candidate(matrix_t *A) {
+  int result = 1;
+  for (int i = 0; i < A->rows && result; i++) {
+    result = A->matrix[i][i] > 0;
+    for (int j = 0; j < i && result; j++) {
+      result = A->matrix[i][j] == A->matrix[j][i];
+    }
+  }
+  return result;
+}
+
+// Unblocked factorization of the diagonal block [k0, k1); earlier blocks
+// were already subtracted by the trailing updates.
+static int factor_diagonal(matrix_t *L, int k0, int k1) {
+  double **l = L->matrix;
+  int error = 0;
+  for (int j = k0; j < k1 && !error; j++) {
+    double d = l[j][j];
+    for (int p = k0; p < j; p++) {
+      d -= l[j][p] * l[j][p];
+    }
+    if (!(d > 0)) {
+      error = 2;
+    } else {
+      l[j][j] = sqrt(d);
+      for (int i = j + 1; i < k1; i++) {
+        double s = l[i][j];
+        for (int p = k0; p < j; p++) {
+          s -= l[i][p] * l[j][p];
+        }
+        l[i][j] = s / l[j][j];
+      }
+    }
+  }
+  return error;
+}
+
+// Rows k1 + [begin, end) of the panel: L21 = A21 * L11^-T, row by row.
+static void solve_panel(void *arg, int begin, int end) {
+  panel_t *args = arg;
+  double **l = args->L->matrix;
+  int k0 = args->k0, k1 = args->k1;
+  for (int i = k1 + begin; i < k1 + end; i++) {
+    for (int j = k0; j < k1; j++) {
+      double s = l[i][j];
+      for (int p = k0; p < j; p++) {
+        s -= l[i][p] * l[j][p];
+      }
+      l[i][j] = s / l[j][j];
+    }
+  }
+}
+
+// A22 -= L21 * L21^T, one block column of the lower triangle at a time.
+static void update_trailing(matrix_t *L, int k0, int k1) {
+  s21_view_t l = view_of(L);
+  int n = L->rows;
+  for (int j0 = k1; j0 < n; j0 += CHOLESKY_BLOCK) {
+    int j1 = j0 + CHOLESKY_BLOCK < n ? j0 + CHOLESKY_BLOCK : n;
+    s21_view_t a = view_block(&l, j0, k0, n - j0, k1 - k0);
+    s21_view_t b = view_block(&l, j0, k0, j1 - j0, k1 - k0);
+    s21_view_transpose(&b);
+    gemm_update(-1, &a, &b, L->matrix + j0, j0);
+  }
+}
+
+// X = (L * L^T)^-1 * X.
+static void solve_factored(matrix_t *L, matrix_t *X) {
+  s21_view_t lower = view_of(L), upper = view_of(L);
+  s21_view_transpose(&upper);
+  forward_substitution(&lower, 0, X);
+  back_substitution(&upper, X);
+}
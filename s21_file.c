@@ -0,0 +1,647 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "s21_matrix.h"
+
+#define FILE_MAGIC "S21MATRX"
+// Written in the saving machine's byte order; a file from a machine of the
+// other order reads back as a different value and is rejected.
+#define FILE_ENDIAN 0x01020304u
+
+// The whole header is one 64-byte block, so the data that follows starts
+// on an S21_ALIGNMENT boundary of the page-aligned mapping. Row i starts
+// at element i * ld of the data; the ld - columns padding elements are
+// zero.
+typedef struct file_header_struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t dtype;
+  uint32_t endian;
+  uint32_t alignment;
+  int64_t rows;
+  int64_t columns;
+  int64_t ld;
+  char reserved[16];
+} file_header_t;
+
+_Static_assert(sizeof(file_header_t) == S21_ALIGNMENT,
+               "the header must keep the data aligned");
+
+// Allocator context of a mapped matrix. Its data block is the mapping and
+// is unmapped when freed; everything else, the row pointers included, goes
+// through the allocator that was current at load time. The row pointers
+// are freed last by s21_remove_matrix, so the mapping record goes with them.
+typedef struct mapping_struct {
+  void *base;
+  size_t length;
+  double *data;
+  double **rows;
+  s21_allocator_t backing;
+} mapping_t;
+
+// Up to two tiles read by a helper thread while the caller computes on
+// others. Without a thread the reads simply happen in prefetch_start.
+typedef struct prefetch_struct {
+  s21_tiled_t *file[2];
+  matrix_t *tile[2];
+  int row[2];
+  int column[2];
+  int count;
+  int started;
+  int error;
+  pthread_t thread;
+} prefetch_t;
+
+static void fill_header(file_header_t *header, int rows, int columns, int ld);
+static int write_matrix(FILE *f, matrix_t *A);
+static int check_header(const file_header_t *header, size_t length);
+static void *mapped_alloc(void *ctx, size_t size, size_t align);
+static void mapped_free(void *ctx, void *ptr);
+static int check_bad_tiled(s21_tiled_t *A);
+static int check_tile(s21_tiled_t *A, int row, int column, matrix_t *tile);
+static int transfer(int fd, void *buffer, size_t size, off_t offset,
+                    int writing);
+static off_t tile_offset(s21_tiled_t *A, int row, int column);
+static void prefetch_mult_step(prefetch_t *job, s21_tiled_t *A,
+                               s21_tiled_t *B, matrix_t *a, matrix_t *b,
+                               long step, int tile);
+static void prefetch_add(prefetch_t *job, s21_tiled_t *A, int row,
+                         int column, matrix_t *tile);
+static void prefetch_start(prefetch_t *job);
+static int prefetch_wait(prefetch_t *job);
+static void *prefetch_run(void *arg);
+static void reset_rows(matrix_t *M, int rows);
+static int factor_tiled(s21_tiled_t *A, int w, int *ipiv, int *singular);
+static int update_tiled(s21_tiled_t *A, matrix_t *P, matrix_t *T, int k0,
+                        int w, const int *ipiv);
+static int swap_left_tiled(s21_tiled_t *A, matrix_t *T, int w,
+                           const int *ipiv);
+
+int s21_save_matrix(matrix_t *A, const char *path) {
+  int error = check_bad_matrix(A) || !path;
+  FILE *f = NULL;
+  if (!error) {
+    f = fopen(path, "wb");
+    error = f ? 0 : 1;
+  }
+  if (!error) {
+    error = write_matrix(f, A);
+    error = fclose(f) || error;
+  }
+  return error;
+}
+
+// The file is mapped copy-on-write: pages are read in on first touch, and
+// writes through the matrix stay private to this process.
+int s21_mmap_matrix(const char *path, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_CREATE);
+  mapping_t *mapping = NULL;
+  struct stat st;
+  int fd = -1, error = !path || !result;
+  if (!error) {
+    result->matrix = NULL;
+    result->data = NULL;
+    fd = open(path, O_RDONLY);
+    error = fd < 0 || fstat(fd, &st) || st.st_size < S21_ALIGNMENT;
+  }
+  if (!error) {
+    mapping = malloc(sizeof(mapping_t));
+    error = mapping ? 0 : 1;
+  }
+  if (!error) {
+    mapping->length = st.st_size;
+    mapping->base = mmap(NULL, mapping->length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, 0);
+    mapping->rows = NULL;
+    error = mapping->base == MAP_FAILED;
+  }
+  if (!error) {
+    error = check_header(mapping->base, mapping->length);
+    if (error) {
+      munmap(mapping->base, mapping->length);
+    }
+  }
+  if (!error) {
+    const file_header_t *header = mapping->base;
+    s21_allocator_t *a = &mapping->backing;
+    *a = *s21_get_allocator();
+    mapping->data = (double *)((char *)mapping->base + sizeof(file_header_t));
+    mapping->rows =
+        a->alloc(a->ctx, header->rows * sizeof(double *), _Alignof(double *));
+    error = mapping->rows ? 0 : 1;
+    if (!error) {
+      STATS_ALLOC(header->rows * sizeof(double *));
+      for (int64_t i = 0; i < header->rows; i++) {
+        mapping->rows[i] = mapping->data + i * header->ld;
+      }
+      result->matrix = mapping->rows;
+      result->data = mapping->data;
+      result->rows = (int)header->rows;
+      result->columns = (int)header->columns;
+      result->ld = (int)header->ld;
+      result->allocator.alloc = mapped_alloc;
+      result->allocator.free = mapped_free;
+      result->allocator.ctx = mapping;
+    } else {
+      munmap(mapping->base, mapping->length);
+    }
+  }
+  if (error) {
+    free(mapping);
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  STATS_END(S21_STAT_CREATE, 0);
+  return error;
+}
+
+int s21_tiled_open(const char *path, s21_tiled_t *result) {
+  file_header_t header;
+  struct stat st;
+  int error = !path || !result;
+  if (!error) {
+    result->fd = open(path, O_RDWR);
+    error = result->fd < 0;
+  }
+  if (!error) {
+    error = fstat(result->fd, &st) || st.st_size < S21_ALIGNMENT ||
+            transfer(result->fd, &header, sizeof(header), 0, 0) ||
+            check_header(&header, st.st_size);
+    if (error) {
+      close(result->fd);
+      result->fd = -1;
+    }
+  }
+  if (!error) {
+    result->rows = (int)header.rows;
+    result->columns = (int)header.columns;
+    result->ld = (int)header.ld;
+  }
+  return error;
+}
+
+// The data is allocated as a hole in the file, so it reads back as zeros
+// and takes disk space only once written.
+int s21_tiled_create(const char *path, int rows, int columns,
+                     s21_tiled_t *result) {
+  file_header_t header;
+  int error = !path || !result || rows <= 0 || columns <= 0;
+  if (!error) {
+    result->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    error = result->fd < 0;
+  }
+  if (!error) {
+    fill_header(&header, rows, columns, columns);
+    off_t size = sizeof(header) + (off_t)rows * columns * sizeof(double);
+    error = transfer(result->fd, &header, sizeof(header), 0, 1) ||
+            ftruncate(result->fd, size);
+    if (error) {
+      close(result->fd);
+      result->fd = -1;
+    }
+  }
+  if (!error) {
+    result->rows = rows;
+    result->columns = columns;
+    result->ld = columns;
+  }
+  return error;
+}
+
+void s21_tiled_close(s21_tiled_t *A) {
+  if (A && A->fd >= 0) {
+    close(A->fd);
+    A->fd = -1;
+  }
+}
+
+int s21_tiled_read(s21_tiled_t *A, int row, int column, matrix_t *tile) {
+  int error = check_tile(A, row, column, tile);
+  for (int i = 0; !error && i < tile->rows; i++) {
+    error = transfer(A->fd, tile->matrix[i], tile->columns * sizeof(double),
+                     tile_offset(A, row + i, column), 0);
+  }
+  return error;
+}
+
+int s21_tiled_write(s21_tiled_t *A, int row, int column, matrix_t *tile) {
+  int error = check_tile(A, row, column, tile);
+  for (int i = 0; !error && i < tile->rows; i++) {
+    error = transfer(A->fd, tile->matrix[i], tile->columns * sizeof(double),
+                     tile_offset(A, row + i, column), 1);
+  }
+  return error;
+}
+
+// C(i, j) accumulates A(i, k) * B(k, j) over k in memory and is written
+// once. The steps (i, j, k) run with k fastest, and the pair of tiles for
+// the next step is read while gemm_update works on the current one.
+int s21_tiled_mult(s21_tiled_t *A, s21_tiled_t *B, s21_tiled_t *result,
+                   int tile) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
+  matrix_t a[2] = {0}, b[2] = {0}, c = {0};
+  prefetch_t jobs[2] = {0};
+  int error = check_bad_tiled(A) || check_bad_tiled(B) ||
+              check_bad_tiled(result) || tile <= 0;
+  if (!error && (A->columns != B->rows || result->rows != A->rows ||
+                 result->columns != B->columns)) {
+    error = 2;
+  }
+  int m = error ? 0 : A->rows, n = error ? 0 : B->columns;
+  int k = error ? 0 : A->columns;
+  int tm = m < tile ? m : tile, tn = n < tile ? n : tile;
+  int tk = k < tile ? k : tile;
+  for (int t = 0; t < 2 && !error; t++) {
+    error = s21_create_matrix(tm, tk, &a[t]) ||
+            s21_create_matrix(tk, tn, &b[t]);
+  }
+  if (!error) {
+    error = s21_create_matrix(tm, tn, &c);
+  }
+  long steps_k = 0, steps_n = 0, steps = 0;
+  if (!error) {
+    steps_k = (k + tile - 1) / tile;
+    steps_n = (n + tile - 1) / tile;
+    steps = steps_k * steps_n * ((m + tile - 1) / tile);
+    prefetch_mult_step(&jobs[0], A, B, &a[0], &b[0], 0, tile);
+  }
+  for (long step = 0; step < steps && !error; step++) {
+    int cur = step & 1, i0 = step / (steps_k * steps_n) * tile;
+    int j0 = step / steps_k % steps_n * tile, kk = step % steps_k;
+    error = prefetch_wait(&jobs[cur]);
+    if (!error && step + 1 < steps) {
+      prefetch_mult_step(&jobs[!cur], A, B, &a[!cur], &b[!cur], step + 1,
+                         tile);
+    }
+    if (!error && kk == 0) {
+      c.rows = a[cur].rows;
+      c.columns = b[cur].columns;
+      for (int i = 0; i < c.rows; i++) {
+        memset(c.matrix[i], 0, c.columns * sizeof(double));
+      }
+    }
+    if (!error) {
+      s21_view_t av = view_of(&a[cur]), bv = view_of(&b[cur]);
+      gemm_update(1, &av, &bv, c.matrix, 0);
+    }
+    if (!error && kk == steps_k - 1) {
+      error = s21_tiled_write(result, i0, j0, &c);
+    }
+  }
+  prefetch_wait(&jobs[0]);
+  prefetch_wait(&jobs[1]);
+  for (int t = 0; t < 2; t++) {
+    s21_remove_matrix(&a[t]);
+    s21_remove_matrix(&b[t]);
+  }
+  s21_remove_matrix(&c);
+  STATS_END(S21_STAT_MULT_MATRIX, error ? 0 : 2.0 * m * n * k);
+  return error;
+}
+
+// Right-looking LU over column panels of width tile, in place in the file:
+// - the panel, all rows from its diagonal down, is read and factored in
+//   memory by lu_decomposition, then written back;
+// - every panel to its right is read (the next one in the background),
+//   takes the panel's row swaps, the U12 solve and the A22 -= L21 * U12
+//   update, and is written back;
+// - the swaps of later panels reach the L of earlier ones in one last
+//   pass over the file.
+// Row k of P * A is row p[k] of A; *singular is set as in s21_lu_t.
+int s21_tiled_lu(s21_tiled_t *A, int tile, int *p, int *singular) {
+  STATS_BEGIN(S21_STAT_LU_FACTOR);
+  int *ipiv = NULL, n = 0;
+  int error = check_bad_tiled(A) || tile <= 0 || !p || !singular;
+  if (!error) {
+    n = A->rows;
+    error = A->rows == A->columns ? 0 : 2;
+  }
+  if (!error) {
+    ipiv = malloc(n * sizeof(int));
+    error = ipiv ? 0 : 1;
+  }
+  if (!error) {
+    error = factor_tiled(A, tile < n ? tile : n, ipiv, singular);
+  }
+  if (!error) {
+    for (int i = 0; i < n; i++) {
+      p[i] = i;
+    }
+    for (int i = 0; i < n; i++) {
+      int temp = p[i];
+      p[i] = p[ipiv[i]];
+      p[ipiv[i]] = temp;
+    }
+  }
+  free(ipiv);
+  STATS_END(S21_STAT_LU_FACTOR, error ? 0 : 2.0 / 3 * n * n * n);
+  return error;
+}
+
+static void fill_header(file_header_t *header, int rows, int columns,
+                        int ld) {
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, FILE_MAGIC, sizeof(header->magic));
+  header->version = S21_FILE_VERSION;
+  header->dtype = S21_DTYPE_FLOAT64;
+  header->endian = FILE_ENDIAN;
+  header->alignment = ld * sizeof(double) % S21_ALIGNMENT == 0
+                          ? S21_ALIGNMENT
+                          : _Alignof(double);
+  header->rows = rows;
+  header->columns = columns;
+  header->ld = ld;
+}
+
+// Rows are written through A->matrix, so matrices whose row pointers were
+// swapped are saved in their logical order.
+static int write_matrix(FILE *f, matrix_t *A) {
+  file_header_t header;
+  fill_header(&header, A->rows, A->columns,
+              A->ld > A->columns ? A->ld : A->columns);
+  const double zero = 0;
+  int error = fwrite(&header, sizeof(header), 1, f) != 1;
+  for (int i = 0; i < A->rows && !error; i++) {
+    error = fwrite(A->matrix[i], sizeof(double), A->columns, f) !=
+            (size_t)A->columns;
+    for (int64_t j = A->columns; j < header.ld && !error; j++) {
+      error = fwrite(&zero, sizeof(double), 1, f) != 1;
+    }
+  }
+  return error;
+}
+
+// Everything a matrix_t needs, and a file long enough to back it.
+static int check_header(const file_header_t *header, size_t length) {
+  int error = memcmp(header->magic, FILE_MAGIC, sizeof(header->magic)) ||
+              header->version != S21_FILE_VERSION ||
+              header->dtype != S21_DTYPE_FLOAT64 ||
+              header->endian != FILE_ENDIAN;
+  if (!error) {
+    error = header->rows <= 0 || header->rows > INT_MAX ||
+            header->columns <= 0 || header->columns > INT_MAX ||
+            header->ld < header->columns || header->ld > INT_MAX ||
+            (header->alignment != _Alignof(double) &&
+             header->alignment != S21_ALIGNMENT);
+  }
+  if (!error) {
+    uint64_t elements = (uint64_t)header->rows * (uint64_t)header->ld;
+    error = elements > (length - sizeof(file_header_t)) / sizeof(double);
+  }
+  return error;
+}
+
+static void *mapped_alloc(void *ctx, size_t size, size_t align) {
+  mapping_t *mapping = ctx;
+  return mapping->backing.alloc(mapping->backing.ctx, size, align);
+}
+
+static void mapped_free(void *ctx, void *ptr) {
+  mapping_t *mapping = ctx;
+  if (ptr == mapping->data) {
+    munmap(mapping->base, mapping->length);
+    mapping->data = NULL;
+  } else {
+    mapping->backing.free(mapping->backing.ctx, ptr);
+    if (ptr == mapping->rows) {
+      if (mapping->data) {
+        munmap(mapping->base, mapping->length);
+      }
+      free(mapping);
+    }
+  }
+}
+
+static int check_bad_tiled(s21_tiled_t *A) {
+  int error = 0;
+  if (!A || A->fd < 0 || A->rows <= 0 || A->columns <= 0) {
+    error = 1;
+  }
+  return error;
+}
+
+// The tile has to lie inside the file's matrix.
+static int check_tile(s21_tiled_t *A, int row, int column, matrix_t *tile) {
+  int error = check_bad_tiled(A) || check_bad_matrix(tile);
+  if (!error && (row < 0 || column < 0 || row > A->rows - tile->rows ||
+                 column > A->columns - tile->columns)) {
+    error = 2;
+  }
+  return error;
+}
+
+// pread or pwrite until size bytes are done; 1 on an error or end of file.
+static int transfer(int fd, void *buffer, size_t size, off_t offset,
+                    int writing) {
+  int error = 0;
+  char *bytes = buffer;
+  while (size && !error) {
+    ssize_t done = writing ? pwrite(fd, bytes, size, offset)
+                         : pread(fd, bytes, size, offset);
+    error = done <= 0;
+    if (!error) {
+      bytes += done;
+      size -= done;
+      offset += done;
+    }
+  }
+  return error;
+}
+
+static off_t tile_offset(s21_tiled_t *A, int row, int column) {
+  return sizeof(file_header_t) +
+         ((off_t)row * A->ld + column) * (off_t)sizeof(double);
+}
+
+// Starts reading the A and B tiles of a step of s21_tiled_mult.
+static void prefetch_mult_step(prefetch_t *job, s21_tiled_t *A,
+                               s21_tiled_t *B, matrix_t *a, matrix_t *b,
+                               long step, int tile) {
+  long steps_k = (A->columns + tile - 1) / tile;
+  long steps_n = (B->columns + tile - 1) / tile;
+  int i0 = step / (steps_k * steps_n) * tile;
+  int j0 = step / steps_k % steps_n * tile, k0 = step % steps_k * tile;
+  a->rows = A->rows - i0 < tile ? A->rows - i0 : tile;
+  a->columns = A->columns - k0 < tile ? A->columns - k0 : tile;
+  b->rows = a->columns;
+  b->columns = B->columns - j0 < tile ? B->columns - j0 : tile;
+  job->count = 0;
+  prefetch_add(job, A, i0, k0, a);
+  prefetch_add(job, B, k0, j0, b);
+  prefetch_start(job);
+}
+
+static void prefetch_add(prefetch_t *job, s21_tiled_t *A, int row,
+                         int column, matrix_t *tile) {
+  job->file[job->count] = A;
+  job->row[job->count] = row;
+  job->column[job->count] = column;
+  job->tile[job->count++] = tile;
+}
+
+static void prefetch_start(prefetch_t *job) {
+  job->error = 0;
+  job->started = !pthread_create(&job->thread, NULL, prefetch_run, job);
+  if (!job->started) {
+    prefetch_run(job);
+  }
+}
+
+static int prefetch_wait(prefetch_t *job) {
+  if (job->started) {
+    pthread_join(job->thread, NULL);
+    job->started = 0;
+  }
+  return job->error;
+}
+
+static void *prefetch_run(void *arg) {
+  prefetch_t *job = arg;
+  for (int t = 0; t < job->count && !job->error; t++) {
+    job->error = s21_tiled_read(job->file[t], job->row[t], job->column[t],
+                                job->tile[t]);
+  }
+  return NULL;
+}
+
+// Back to one row per ld elements, undoing pointer swaps.
+static void reset_rows(matrix_t *M, int rows) {
+  for (int i = 0; i < rows; i++) {
+    M->matrix[i] = M->data + (size_t)i * M->ld;
+  }
+}
+
+// ipiv[k] is the row that row k traded places with at step k, which is
+// all the later passes need to replay the panel's pivoting.
+static int factor_tiled(s21_tiled_t *A, int w, int *ipiv, int *singular) {
+  matrix_t P = {0}, T[2] = {0};
+  int n = A->rows, *lp = malloc(n * sizeof(int)), *where = NULL, *at = NULL;
+  int error = !lp || s21_create_matrix(n, w, &P) ||
+              s21_create_matrix(n, w, &T[0]) ||
+              s21_create_matrix(n, w, &T[1]);
+  if (!error) {
+    where = malloc(2 * n * sizeof(int));
+    error = where ? 0 : 1;
+    at = where + n;
+  }
+  *singular = 0;
+  for (int k0 = 0; k0 < n && !error; k0 += w) {
+    int h = n - k0, swaps = 0;
+    reset_rows(&P, n);
+    P.rows = h;
+    P.columns = n - k0 < w ? n - k0 : w;
+    error = s21_tiled_read(A, k0, k0, &P);
+    if (!error) {
+      for (int i = 0; i < h; i++) {
+        lp[i] = i;
+        where[i] = i;
+        at[i] = i;
+      }
+      *singular = lu_decomposition(&P, lp, &swaps) || *singular;
+      error = s21_tiled_write(A, k0, k0, &P);
+    }
+    // lp is turned back into the transpositions that produced it; at and
+    // where track which row sits where as they are replayed.
+    for (int i = 0; !error && i < P.columns; i++) {
+      int q = where[lp[i]];
+      ipiv[k0 + i] = k0 + q;
+      at[q] = at[i];
+      where[at[q]] = q;
+      at[i] = lp[i];
+      where[lp[i]] = i;
+    }
+    if (!error) {
+      error = update_tiled(A, &P, T, k0, w, ipiv);
+    }
+  }
+  if (!error) {
+    error = swap_left_tiled(A, &T[0], w, ipiv);
+  }
+  free(lp);
+  free(where);
+  s21_remove_matrix(&P);
+  s21_remove_matrix(&T[0]);
+  s21_remove_matrix(&T[1]);
+  return error;
+}
+
+// The panels right of the one at k0, each read while the previous one is
+// updated.
+static int update_tiled(s21_tiled_t *A, matrix_t *P, matrix_t *T, int k0,
+                        int w, const int *ipiv) {
+  int n = A->rows, h = n - k0, kw = P->columns, error = 0;
+  prefetch_t jobs[2] = {0};
+  s21_view_t panel = view_of(P);
+  s21_view_t l11 = view_block(&panel, 0, 0, kw, kw);
+  s21_view_t l21 = view_block(&panel, kw, 0, h - kw, kw);
+  for (int j0 = k0 + kw, cur = 0; j0 < n && !error; j0 += w, cur = !cur) {
+    if (j0 == k0 + kw) {
+      reset_rows(&T[cur], n);
+      T[cur].rows = h;
+      T[cur].columns = n - j0 < w ? n - j0 : w;
+      jobs[cur].count = 0;
+      prefetch_add(&jobs[cur], A, k0, j0, &T[cur]);
+      prefetch_start(&jobs[cur]);
+    }
+    error = prefetch_wait(&jobs[cur]);
+    if (!error && j0 + w < n) {
+      reset_rows(&T[!cur], n);
+      T[!cur].rows = h;
+      T[!cur].columns = n - j0 - w < w ? n - j0 - w : w;
+      jobs[!cur].count = 0;
+      prefetch_add(&jobs[!cur], A, k0, j0 + w, &T[!cur]);
+      prefetch_start(&jobs[!cur]);
+    }
+    if (!error) {
+      matrix_t *t = &T[cur], u12 = *t;
+      for (int i = 0; i < kw; i++) {
+        double *temp = t->matrix[i];
+        t->matrix[i] = t->matrix[ipiv[k0 + i] - k0];
+        t->matrix[ipiv[k0 + i] - k0] = temp;
+      }
+      u12.rows = kw;
+      forward_substitution(&l11, 1, &u12);
+      if (h > kw) {
+        s21_view_t u = view_of(&u12);
+        gemm_update(-1, &l21, &u, t->matrix + kw, 0);
+      }
+      error = s21_tiled_write(A, k0, j0, t);
+    }
+  }
+  prefetch_wait(&jobs[0]);
+  prefetch_wait(&jobs[1]);
+  return error;
+}
+
+// Rows below panel j0 were still moved by the pivoting of later panels.
+static int swap_left_tiled(s21_tiled_t *A, matrix_t *T, int w,
+                           const int *ipiv) {
+  int n = A->rows, error = 0;
+  for (int j0 = 0; j0 + w < n && !error; j0 += w) {
+    int j1 = j0 + w;
+    reset_rows(T, n);
+    T->rows = n - j1;
+    T->columns = w;
+    error = s21_tiled_read(A, j1, j0, T);
+    for (int k = j1; k < n && !error; k++) {
+      double *temp = T->matrix[k - j1];
+      T->matrix[k - j1] = T->matrix[ipiv[k] - j1];
+      T->matrix[ipiv[k] - j1] = temp;
+    }
+    if (!error) {
+      error = s21_tiled_write(A, j1, j0, T);
+    }
+  }
+  return error;
+}
@@ -0,0 +1,580 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+// float keeps about seven significant digits, so elements compare to this
+// absolute tolerance instead of matrix_t's 1e-7.
+#define EPS_F 1e-6f
+// The blocking of the double product with a register tile twice as wide:
+// the same bytes per sliver hold twice the elements.
+#define GEMM_MR 4
+#define GEMM_NR 16
+#define GEMM_MC 96
+#define GEMM_KC 256
+#define GEMM_NC 2048
+// Below this many multiply-adds packing costs more than it saves.
+#define GEMM_SMALL (32 * 32 * 32)
+// Below this many multiply-adds a product is not worth a thread.
+#define GEMM_PARALLEL (128 * 128 * 128)
+// The LU blocking of s21_linear.c, with twice the elements per thread in
+// the elimination steps.
+#define LU_BLOCK 64
+#define ELIMINATION_GRAIN (1 << 15)
+#define TRSM_BLOCK 64
+// Smallest number of elements handed to one thread by elementwise ops.
+#define ELEMENTWISE_F_GRAIN (1 << 15)
+// Corrections s21_solve_mixed tries before it gives up on float.
+#define REFINE_STEPS 30
+
+enum elementwise_f_op { OP_SUM, OP_SUB, OP_MULT_NUMBER };
+
+typedef struct elementwise_f_struct {
+  int op;
+  matrix_f_t *A;
+  matrix_f_t *B;
+  float number;
+  matrix_f_t *result;
+} elementwise_f_t;
+
+// s21_view_t over float rows, for the shared product and LU.
+typedef struct view_f_struct {
+  float **matrix;
+  int row;
+  int column;
+  int rows;
+  int columns;
+  int row_step;
+  int column_step;
+  int transposed;
+} view_f_t;
+
+static int check_bad_matrix_f(matrix_f_t *A);
+static int check_eq_dim_f(matrix_f_t *A, matrix_f_t *B);
+static int check_bad_lu_f(s21_lu_f_t *lu);
+static int cycle_elementwise_f(int op, matrix_f_t *A, matrix_f_t *B,
+                               float number, matrix_f_t *result);
+static void elementwise_f_rows(void *arg, int begin, int end);
+static void gemm_update_f(float alpha, const view_f_t *a, const view_f_t *b,
+                          float **c, int cc);
+static int lu_decomposition_f(matrix_f_t *LU, int *p, int *s);
+static void substitute_f(matrix_f_t *LU, matrix_f_t *X);
+static view_f_t view_of_f(matrix_f_t *A);
+static float *view_at_f(const view_f_t *view, int i, int j);
+static view_f_t view_block_f(const view_f_t *view, int i, int j, int rows,
+                             int columns);
+static void residual(matrix_t *A, matrix_t *B, matrix_t *X, matrix_t *R);
+
+int s21_create_matrix_f(int rows, int columns, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_CREATE);
+  int error = !result || rows <= 0 || columns <= 0;
+  float *data = NULL;
+  if (result) {
+    result->matrix = NULL;
+    result->data = NULL;
+    result->ld = 0;
+    result->allocator = *s21_get_allocator();
+  }
+  s21_allocator_t *a = result ? &result->allocator : NULL;
+  if (!error) {
+    result->matrix =
+        a->alloc(a->ctx, rows * sizeof(float *), _Alignof(float *));
+    error = result->matrix ? 0 : 1;
+  }
+  if (!error) {
+    size_t size = (size_t)rows * columns * sizeof(float);
+    data = a->alloc(a->ctx, size, _Alignof(float));
+    if (!data) {
+      error = 1;
+      a->free(a->ctx, result->matrix);
+      result->matrix = NULL;
+    } else {
+      memset(data, 0, size);
+      STATS_ALLOC(size + rows * sizeof(float *));
+    }
+  }
+  if (!error) {
+    for (int i = 0; i < rows; i++) {
+      result->matrix[i] = data + (size_t)i * columns;
+    }
+    result->data = data;
+    result->ld = columns;
+    result->rows = rows;
+    result->columns = columns;
+  }
+  STATS_END(S21_STAT_CREATE, 0);
+  return error;
+}
+
+void s21_remove_matrix_f(matrix_f_t *A) {
+  if (A && A->matrix) {
+    s21_allocator_t *a = &A->allocator;
+    if (A->data) {
+      a->free(a->ctx, A->data);
+      A->data = NULL;
+    }
+    a->free(a->ctx, A->matrix);
+    A->matrix = NULL;
+    A->rows = 0;
+    A->columns = 0;
+    A->ld = 0;
+  }
+}
+
+// Elements beyond float's range become infinite, as a cast makes them.
+int s21_to_float(matrix_t *A, matrix_f_t *result) {
+  int error = check_bad_matrix(A);
+  if (!error) {
+    error = s21_create_matrix_f(A->rows, A->columns, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      result->matrix[i][j] = (float)A->matrix[i][j];
+    }
+  }
+  return error;
+}
+
+int s21_to_double(matrix_f_t *A, matrix_t *result) {
+  int error = check_bad_matrix_f(A);
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->columns, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      result->matrix[i][j] = A->matrix[i][j];
+    }
+  }
+  return error;
+}
+
+int s21_eq_matrix_f(matrix_f_t *A, matrix_f_t *B) {
+  STATS_BEGIN(S21_STAT_EQ);
+  int error = check_bad_matrix_f(A) || check_bad_matrix_f(B);
+  if (!error) {
+    error = check_eq_dim_f(A, B);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      error |= !(fabsf(A->matrix[i][j] - B->matrix[i][j]) <= EPS_F);
+    }
+  }
+  STATS_END(S21_STAT_EQ, error ? 0 : (double)A->rows * A->columns);
+  return error ? FAILURE : SUCCESS;
+}
+
+int s21_sum_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_SUM);
+  int error = check_bad_matrix_f(A) || check_bad_matrix_f(B);
+  if (!error) {
+    error = check_eq_dim_f(A, B);
+  }
+  if (!error) {
+    error = cycle_elementwise_f(OP_SUM, A, B, 0, result);
+  }
+  STATS_END(S21_STAT_SUM, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_sub_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_SUB);
+  int error = check_bad_matrix_f(A) || check_bad_matrix_f(B);
+  if (!error) {
+    error = check_eq_dim_f(A, B);
+  }
+  if (!error) {
+    error = cycle_elementwise_f(OP_SUB, A, B, 0, result);
+  }
+  STATS_END(S21_STAT_SUB, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_mult_number_f(matrix_f_t *A, float number, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_NUMBER);
+  int error = check_bad_matrix_f(A);
+  if (!error) {
+    error = cycle_elementwise_f(OP_MULT_NUMBER, A, NULL, number, result);
+  }
+  STATS_END(S21_STAT_MULT_NUMBER, error ? 0 : (double)A->rows * A->columns);
+  return error;
+}
+
+int s21_mult_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_MULT_MATRIX);
+  int error = check_bad_matrix_f(A) || check_bad_matrix_f(B);
+  if (!error && A->columns != B->rows) {
+    error = 2;
+  }
+  if (!error) {
+    error = s21_create_matrix_f(A->rows, B->columns, result);
+  }
+  if (!error) {
+    view_f_t a = view_of_f(A), b = view_of_f(B);
+    gemm_update_f(1, &a, &b, result->matrix, 0);
+  }
+  STATS_END(S21_STAT_MULT_MATRIX,
+            error ? 0 : 2.0 * A->rows * A->columns * B->columns);
+  return error;
+}
+
+int s21_transpose_f(matrix_f_t *A, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_TRANSPOSE);
+  int error = check_bad_matrix_f(A);
+  if (!error) {
+    error = s21_create_matrix_f(A->columns, A->rows, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      result->matrix[j][i] = A->matrix[i][j];
+    }
+  }
+  STATS_END(S21_STAT_TRANSPOSE, 0);
+  return error;
+}
+
+// Complements go through the double path: singular matrices need its
+// complete pivoting, and nothing about them is throughput bound.
+int s21_calc_complements_f(matrix_f_t *A, matrix_f_t *result) {
+  matrix_t a = {0}, complements = {0};
+  int error = s21_to_double(A, &a);
+  if (!error) {
+    error = s21_calc_complements(&a, &complements);
+  }
+  if (!error) {
+    error = s21_to_float(&complements, result);
+  }
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&complements);
+  return error;
+}
+
+int s21_determinant_f(matrix_f_t *A, float *result) {
+  STATS_BEGIN(S21_STAT_DETERMINANT);
+  s21_lu_f_t lu = {0};
+  int error = !result || s21_lu_factor_f(A, &lu);
+  if (!error) {
+    *result = lu.singular ? 0 : (lu.swaps & 1 ? -1 : 1);
+    for (int i = 0; i < lu.LU.rows && !lu.singular; i++) {
+      *result *= lu.LU.matrix[i][i];
+    }
+  }
+  s21_lu_remove_f(&lu);
+  STATS_END(S21_STAT_DETERMINANT,
+            error ? 0 : 2.0 / 3 * A->rows * A->rows * A->rows);
+  return error;
+}
+
+int s21_inverse_matrix_f(matrix_f_t *A, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_INVERSE);
+  s21_lu_f_t lu = {0};
+  int error = s21_lu_factor_f(A, &lu);
+  if (!error) {
+    error = lu.singular ? 2 : 0;
+  }
+  if (!error) {
+    error = s21_create_matrix_f(A->rows, A->rows, result);
+  }
+  if (!error) {
+    for (int i = 0; i < A->rows; i++) {
+      result->matrix[i][lu.p[i]] = 1;
+    }
+    substitute_f(&lu.LU, result);
+  }
+  s21_lu_remove_f(&lu);
+  STATS_END(S21_STAT_INVERSE, error ? 0 : 2.0 * A->rows * A->rows * A->rows);
+  return error;
+}
+
+int s21_lu_factor_f(matrix_f_t *A, s21_lu_f_t *lu) {
+  STATS_BEGIN(S21_STAT_LU_FACTOR);
+  int error = check_bad_matrix_f(A) || !lu, n = 0;
+  if (lu) {
+    lu->LU.matrix = NULL;
+    lu->p = NULL;
+    lu->swaps = 0;
+    lu->singular = 0;
+  }
+  if (!error) {
+    n = A->rows;
+    error = A->rows == A->columns ? 0 : 2;
+  }
+  if (!error) {
+    error = s21_create_matrix_f(n, n, &lu->LU);
+  }
+  if (!error) {
+    s21_allocator_t *a = &lu->LU.allocator;
+    lu->p = a->alloc(a->ctx, n * sizeof(int), _Alignof(int));
+    error = lu->p ? 0 : 1;
+  }
+  if (!error) {
+    STATS_ALLOC(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+      lu->p[i] = i;
+      memcpy(lu->LU.matrix[i], A->matrix[i], n * sizeof(float));
+    }
+    lu->singular = lu_decomposition_f(&lu->LU, lu->p, &lu->swaps);
+  } else {
+    s21_lu_remove_f(lu);
+  }
+  STATS_END(S21_STAT_LU_FACTOR, error ? 0 : 2.0 / 3 * n * n * n);
+  return error;
+}
+
+int s21_lu_solve_f(s21_lu_f_t *lu, matrix_f_t *B, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_LU_SOLVE);
+  int error = check_bad_lu_f(lu) || check_bad_matrix_f(B);
+  if (!error) {
+    error = (B->rows != lu->LU.rows || lu->singular) ? 2 : 0;
+  }
+  if (!error) {
+    error = s21_create_matrix_f(B->rows, B->columns, result);
+  }
+  if (!error) {
+    for (int i = 0; i < B->rows; i++) {
+      memcpy(result->matrix[i], B->matrix[lu->p[i]],
+             B->columns * sizeof(float));
+    }
+    substitute_f(&lu->LU, result);
+  }
+  STATS_END(S21_STAT_LU_SOLVE, error ? 0 : 2.0 * B->rows * B->rows * B->columns);
+  return error;
+}
+
+void s21_lu_remove_f(s21_lu_f_t *lu) {
+  if (lu) {
+    if (lu->p) {
+      lu->LU.allocator.free(lu->LU.allocator.ctx, lu->p);
+      lu->p = NULL;
+    }
+    s21_remove_matrix_f(&lu->LU);
+    lu->swaps = 0;
+    lu->singular = 0;
+  }
+}
+
+int s21_solve_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result) {
+  STATS_BEGIN(S21_STAT_SOLVE);
+  s21_lu_f_t lu = {0};
+  int error = check_bad_matrix_f(B);
+  if (!error) {
+    error = s21_lu_factor_f(A, &lu);
+  }
+  if (!error) {
+    error = s21_lu_solve_f(&lu, B, result);
+  }
+  s21_lu_remove_f(&lu);
+  STATS_END(S21_STAT_SOLVE,
+            error ? 0
+                  : 2.0 / 3 * A->rows * A->rows * A->rows +
+                        2.0 * B->rows * B->rows * B->columns);
+  return error;
+}
+
+// Iterative refinement as in LAPACK's dsgesv: X starts at zero, and each
+// step solves A * D = B - A * X in float and adds D to X. A column is done
+// when its residual is within sqrt(n) * eps * ||A||_F of its X. result is
+// only touched once the float factorization succeeds, so the fallback gets
+// it as the caller passed it.
+int s21_solve_mixed(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SOLVE_MIXED);
+  matrix_f_t a = {0}, r = {0}, d = {0};
+  matrix_t R = {0};
+  s21_lu_f_t lu = {0};
+  int refined = 0, created = 0, step = 0;
+  int error = check_bad_matrix(A) || check_bad_matrix(B);
+  if (!error) {
+    error = (A->rows != A->columns || B->rows != A->rows) ? 2 : 0;
+  }
+  if (!error) {
+    error = s21_to_float(A, &a) || s21_lu_factor_f(&a, &lu);
+  }
+  if (!error && !lu.singular) {
+    error = s21_create_matrix(B->rows, B->columns, result);
+    created = !error;
+  }
+  if (!error && !lu.singular) {
+    error = s21_create_matrix(B->rows, B->columns, &R) ||
+            s21_create_matrix_f(B->rows, B->columns, &r);
+  }
+  double norm = 0;
+  for (int i = 0; !error && !lu.singular && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      norm += A->matrix[i][j] * A->matrix[i][j];
+    }
+  }
+  double bound = sqrt(norm) * DBL_EPSILON * sqrt(A->rows);
+  for (; !error && !lu.singular && !refined && step <= REFINE_STEPS; step++) {
+    residual(A, B, result, &R);
+    refined = step > 0 && is_refined(&R, result, bound);
+    for (int i = 0; !error && !refined && i < R.rows; i++) {
+      for (int j = 0; j < R.columns; j++) {
+        r.matrix[i][j] = (float)R.matrix[i][j];
+      }
+    }
+    if (!error && !refined) {
+      error = s21_lu_solve_f(&lu, &r, &d);
+    }
+    for (int i = 0; !error && !refined && i < R.rows; i++) {
+      for (int j = 0; j < R.columns; j++) {
+        result->matrix[i][j] += d.matrix[i][j];
+      }
+    }
+    s21_remove_matrix_f(&d);
+  }
+  if (created && (error || !refined)) {
+    s21_remove_matrix(result);
+  }
+  if (!error && !refined) {
+    error = s21_solve(A, B, result);
+  }
+  s21_remove_matrix_f(&a);
+  s21_remove_matrix_f(&r);
+  s21_remove_matrix(&R);
+  s21_lu_remove_f(&lu);
+  // Each step is a residual and a float solve; the fallback adds a full
+  // double solve.
+  STATS_END(S21_STAT_SOLVE_MIXED,
+            error ? 0
+                  : 2.0 / 3 * A->rows * A->rows * A->rows +
+                        4.0 * step * B->rows * B->rows * B->columns +
+                        (refined ? 0
+                                 : 2.0 / 3 * A->rows * A->rows * A->rows +
+                                       2.0 * B->rows * B->rows * B->columns));
+  return error;
+}
+
+static int check_bad_matrix_f(matrix_f_t *A) {
+  int error = 0;
+  if (!A || !(A->matrix) || A->columns <= 0 || A->rows <= 0) {
+    error = 1;
+  } else {
+    for (int i = 0; i < A->rows && !error; i++) {
+      if (!(A->matrix[i])) {
+        error = 1;
+      }
+    }
+  }
+  return error;
+}
+
+static int check_eq_dim_f(matrix_f_t *A, matrix_f_t *B) {
+  int error = 0;
+  if (A->rows != B->rows || A->columns != B->columns) {
+    error = 2;
+  }
+  return error;
+}
+
+static int check_bad_lu_f(s21_lu_f_t *lu) {
+  int error = 0;
+  if (!lu || !(lu->p) || check_bad_matrix_f(&lu->LU)) {
+    error = 1;
+  }
+  return error;
+}
+
+static int cycle_elementwise_f(int op, matrix_f_t *A, matrix_f_t *B,
+                               float number, matrix_f_t *result) {
+  int error = s21_create_matrix_f(A->rows, A->columns, result);
+  if (!error) {
+    elementwise_f_t args = {op, A, B, number, result};
+    int grain = ELEMENTWISE_F_GRAIN / A->columns + 1;
+    parallel_for(A->rows, grain, elementwise_f_rows, &args);
+  }
+  return error;
+}
+
+// All three ops are axpy on the zeroed result: r = a + b is r += a then
+// r += b, so they share the one float kernel.
+static void elementwise_f_rows(void *arg, int begin, int end) {
+  elementwise_f_t *args = arg;
+  const simd_kernels_t *kernels = simd_kernels();
+  int n = args->A->columns;
+  for (int i = begin; i < end; i++) {
+    float *r = args->result->matrix[i];
+    if (args->op == OP_MULT_NUMBER) {
+      kernels->axpy_f(args->number, args->A->matrix[i], r, n);
+    } else {
+      kernels->axpy_f(1, args->A->matrix[i], r, n);
+      kernels->axpy_f(args->op == OP_SUM ? 1 : -1, args->B->matrix[i], r, n);
+    }
+  }
+}
+
+// The product and the LU of s21_arithmetic.c and s21_linear.c, generated
+// for float.
+#define SCALAR float
+#define SCALAR_NAME(name) name##_f
+#define SCALAR_MATRIX matrix_f_t
+#define SCALAR_VIEW view_f_t
+#define SCALAR_VIEW_OF view_of_f
+#define SCALAR_VIEW_AT view_at_f
+#define SCALAR_VIEW_BLOCK view_block_f
+#define GEMM_MICRO_KERNEL gemm_4x16_f
+#define LU_GEMM_UPDATE gemm_update_f
+#define LU_LINKAGE static
+#include "s21_gemm.inc"
+#include "s21_lu.inc"
+
+static void gemm_update_f(float alpha, const view_f_t *a, const view_f_t *b,
+                          float **c, int cc) {
+  gemm_scaled_f(alpha, a, b, 1, c, cc);
+}
+
+// X = U^-1 * L^-1 * X for the packed factors, all columns of X at once.
+static void substitute_f(matrix_f_t *LU, matrix_f_t *X) {
+  view_f_t lu = view_of_f(LU);
+  forward_substitution_f(&lu, 1, X);
+  back_substitution_f(&lu, X);
+}
+
+static view_f_t view_of_f(matrix_f_t *A) {
+  view_f_t view = {A->matrix, 0, 0, A->rows, A->columns, 1, 1, 0};
+  return view;
+}
+
+static float *view_at_f(const view_f_t *view, int i, int j) {
+  int r = view->transposed ? j : i, c = view->transposed ? i : j;
+  return view->matrix[view->row + (long)r * view->row_step] + view->column +
+         (long)c * view->column_step;
+}
+
+static view_f_t view_block_f(const view_f_t *view, int i, int j, int rows,
+                             int columns) {
+  view_f_t block = *view;
+  int r = view->transposed ? j : i, c = view->transposed ? i : j;
+  block.row += r * view->row_step;
+  block.column += c * view->column_step;
+  block.rows = rows;
+  block.columns = columns;
+  return block;
+}
+
+// R = B - A * X in double: the one step that needs the extra precision.
+static void residual(matrix_t *A, matrix_t *B, matrix_t *X, matrix_t *R) {
+  for (int i = 0; i < B->rows; i++) {
+    memcpy(R->matrix[i], B->matrix[i], B->columns * sizeof(double));
+  }
+  s21_view_t a = view_of(A), x = view_of(X);
+  gemm_update(-1, &a, &x, R->matrix, 0);
+}
+
+// 1 when every column of R is within bound times the largest entry of the
+// same column of X. A NaN or infinity in either is never refined: the max
+// below would drop a NaN followed by a finite entry.
+int is_refined(matrix_t *R, matrix_t *X, double bound) {
+  int refined = 1;
+  for (int j = 0; j < R->columns && refined; j++) {
+    double r = 0, x = 0;
+    for (int i = 0; i < R->rows && refined; i++) {
+      double ri = fabs(R->matrix[i][j]), xi = fabs(X->matrix[i][j]);
+      refined = isfinite(ri) && isfinite(xi);
+      r = r > ri ? r : ri;
+      x = x > xi ? x : xi;
+    }
+    refined = refined && r <= x * bound;
+  }
+  return refined;
+}
@@ -1,21 +1,51 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "s21_matrix.h"
 
+// Smallest number of panel elements handed to one thread.
+#define ELIMINATION_GRAIN (1 << 14)
+// Columns per LU panel; everything right of a panel is updated by GEMM.
+#define LU_BLOCK 64
+// Transposes go tile by tile: a 32 x 32 source tile and its destination
+// both stay in L1 while the 4 x 4 kernel walks them.
+#define TRANSPOSE_TILE 32
+#define TRANSPOSE_GRAIN (1 << 15)
+// Triangular solves go this many rows at a time: the diagonal block is
+// solved row by row, then the rest of X is updated with one product.
+#define TRSM_BLOCK 64
+
+typedef struct transpose_struct {
+  matrix_t *A;
+  matrix_t *result;
+} transpose_t;
+
 static int cycle_transpose_matrix(matrix_t *A, matrix_t *result);
+static void transpose_tiles(void *arg, int begin, int end);
+static void transpose_tile(double **a, double **r, int i0, int i1, int j0,
+                           int j1);
+static void transpose_tiles_inplace(void *arg, int begin, int end);
+static void swap_blocks(double **a, int i, int j);
 static int det_by_lu(matrix_t *A, double *det);
-static int create_L(matrix_t *L, int n);
-static int create_U(matrix_t *A, matrix_t *U, int n);
-static int create_p(int **p, int n);
-static int lu_decomposition(int n, matrix_t *L, matrix_t *U, int *p, int *s);
-static void perm(matrix_t *U, int *p, int *s, int n, int r1, int r2);
-static void remove_vector(int **p);
+static int check_bad_lu(s21_lu_t *lu);
+static int create_LU(matrix_t *A, matrix_t *LU, int n);
+static int create_p(int **p, int n, s21_allocator_t *allocator);
+static void init_permutation(matrix_t *X, int *p, int n);
+static void remove_vector(int **p, s21_allocator_t *allocator);
 static int is_square(matrix_t *A);
 static int create_minor(matrix_t *A, int n, int i, int j, matrix_t *minor);
+static int adjugate_complements(matrix_t *A, matrix_t *result);
+static int rank_one_complements(matrix_t *A, matrix_t *result);
+static int complete_pivoting(matrix_t *M, int *p, int *q, int *s);
+static void swap_columns(matrix_t *M, int *q, int *s, int c1, int c2);
+static void gather_small(matrix_t *A, double *a);
+static void gather_view(const s21_view_t *A, double *a);
+static void scatter_small(const double *a, int n, matrix_t *result);
 
 int s21_transpose(matrix_t *A, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_TRANSPOSE);
   int error = check_bad_matrix(A);
   if (!error) {
     error = s21_create_matrix(A->columns, A->rows, result);
@@ -23,10 +53,58 @@ int s21_transpose(matrix_t *A, matrix_t *result) {
   if (!error) {
     error = cycle_transpose_matrix(A, result);
   }
+  STATS_END(S21_STAT_TRANSPOSE, 0);
+  return error;
+}
+
+int s21_transpose_into(matrix_t *A, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_TRANSPOSE);
+  int error = check_bad_matrix(A) || check_bad_matrix(result);
+  if (!error) {
+    if (result->rows != A->columns || result->columns != A->rows ||
+        check_aliasing(A, result)) {
+      error = 2;
+    }
+  }
+  if (!error) {
+    error = cycle_transpose_matrix(A, result);
+  }
+  STATS_END(S21_STAT_TRANSPOSE, 0);
+  return error;
+}
+
+void s21_fast_transpose(matrix_t *A, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_TRANSPOSE);
+  cycle_transpose_matrix(A, result);
+  STATS_END(S21_STAT_TRANSPOSE, 0);
+}
+
+int s21_transpose_inplace(matrix_t *A) {
+  STATS_BEGIN(S21_STAT_TRANSPOSE);
+  int error = check_bad_matrix(A);
+  if (!error) {
+    error = is_square(A) ? 0 : 2;
+  }
+  if (!error) {
+    transpose_t args = {A, NULL};
+    int n = A->rows, n4 = n & ~3;
+    int tiles = (n4 + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    int grain = TRANSPOSE_GRAIN / (TRANSPOSE_TILE * n) + 1;
+    parallel_for(tiles, grain, transpose_tiles_inplace, &args);
+    for (int i = 0; i < n; i++) {
+      for (int j = i + 1 > n4 ? i + 1 : n4; j < n; j++) {
+        double temp = A->matrix[i][j];
+        A->matrix[i][j] = A->matrix[j][i];
+        A->matrix[j][i] = temp;
+      }
+    }
+  }
+  STATS_END(S21_STAT_TRANSPOSE, 0);
   return error;
 }
 
 int s21_calc_complements(matrix_t *A, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_CALC_COMPLEMENTS);
   int error = check_bad_matrix(A), n = A->rows;
   if (!error) {
     error = is_square(A) ? 0 : 2;
@@ -34,18 +112,99 @@ int s21_calc_complements(matrix_t *A, matrix_t *result) {
   if (!error) {
     error = s21_create_matrix(A->columns, A->rows, result);
   }
-  for (int i = 0; i < n && !error; i++) {
-    for (int j = 0; j < n && !error; j++) {
-      matrix_t minor;
-      double det;
-      error = create_minor(A, n, i, j, &minor);
-      if (!error) {
-        error = s21_determinant(&minor, &det);
-        result->matrix[i][j] = det * ((i + j) & 1 ? -1 : 1);
+  if (!error && n > 1 && n <= SMALL_ORDER) {
+    double a[SMALL_ORDER * SMALL_ORDER];
+    gather_small(A, a);
+    small_complements(n, a, a);
+    scatter_small(a, n, result);
+  } else if (!error && n > SMALL_ORDER) {
+    error = adjugate_complements(A, result);
+  } else {
+    for (int i = 0; i < n && !error; i++) {
+      for (int j = 0; j < n && !error; j++) {
+        matrix_t minor;
+        double det = 0;
+        error = create_minor(A, n, i, j, &minor);
+        if (!error) {
+          error = s21_determinant(&minor, &det);
+          result->matrix[i][j] = det * ((i + j) & 1 ? -1 : 1);
+        }
+        s21_remove_matrix(&minor);
+      }
+    }
+  }
+  STATS_END(S21_STAT_CALC_COMPLEMENTS,
+            error ? 0
+            : n > SMALL_ORDER
+                ? 8.0 / 3 * n * n * n
+                : 2.0 / 3 * n * n * (n - 1) * (n - 1) * (n - 1));
+  return error;
+}
+
+// C = det(A) * (A^-1)^T, all from one LU. A singular A has no inverse, so
+// it goes to rank_one_complements instead.
+static int adjugate_complements(matrix_t *A, matrix_t *result) {
+  s21_lu_t lu = {0};
+  matrix_t inverse = {0};
+  double det = 0;
+  int error = s21_lu_factor(A, &lu);
+  if (!error && lu.singular) {
+    error = rank_one_complements(A, result);
+  } else if (!error) {
+    error = s21_lu_det(&lu, &det) || s21_lu_inverse(&lu, &inverse);
+    if (!error) {
+      error = s21_transpose_into(&inverse, result);
+    }
+    if (!error) {
+      error = s21_mult_number_inplace(result, det);
+    }
+  }
+  s21_remove_matrix(&inverse);
+  s21_lu_remove(&lu);
+  return error;
+}
+
+// With P * A * Q = L * U and U's last pivot taken as zero, the complements
+// of a singular A are C[p[r]][q[c]] = d * w[r] * z[c], where d is the
+// signed product of the other pivots, U * z = 0 and L^T * w = e_n, both
+// with a last entry of 1. Rank below n - 1 leaves d and so C at zero. The
+// last pivot is only rounding noise here: partial pivoting already hit an
+// exact zero.
+static int rank_one_complements(matrix_t *A, matrix_t *result) {
+  matrix_t M = {0}, zw = {0};
+  int *p = NULL, *q = NULL, n = A->rows, swaps = 0;
+  int error = create_LU(A, &M, n);
+  if (!error) {
+    error = create_p(&p, n, &M.allocator) || create_p(&q, n, &M.allocator) ||
+            s21_create_matrix(2, n, &zw);
+  }
+  if (!error && complete_pivoting(&M, p, q, &swaps) >= n - 1) {
+    double **m = M.matrix, *z = zw.matrix[0], *w = zw.matrix[1];
+    double d = swaps & 1 ? -1 : 1;
+    z[n - 1] = 1;
+    w[n - 1] = 1;
+    for (int i = n - 2; i >= 0; i--) {
+      d *= m[i][i];
+      for (int j = i + 1; j < n; j++) {
+        z[i] -= m[i][j] * z[j];
+      }
+      z[i] /= m[i][i];
+    }
+    for (int k = n - 1; k > 0; k--) {
+      for (int i = 0; i < k; i++) {
+        w[i] -= m[k][i] * w[k];
+      }
+    }
+    for (int r = 0; r < n; r++) {
+      for (int c = 0; c < n; c++) {
+        result->matrix[p[r]][q[c]] = d * w[r] * z[c];
       }
-      s21_remove_matrix(&minor);
     }
   }
+  remove_vector(&p, &M.allocator);
+  remove_vector(&q, &M.allocator);
+  s21_remove_matrix(&zw);
+  s21_remove_matrix(&M);
   return error;
 }
 
@@ -69,112 +228,377 @@ static int create_minor(matrix_t *A, int n, int i, int j, matrix_t *minor) {
 }
 
 int s21_determinant(matrix_t *A, double *result) {
+  STATS_BEGIN(S21_STAT_DETERMINANT);
   int error = check_bad_matrix(A);
   if (!error) {
     error = is_square(A) ? 0 : 2;
   }
+  if (!error && A->rows <= SMALL_ORDER) {
+    double a[SMALL_ORDER * SMALL_ORDER];
+    gather_small(A, a);
+    error = result ? 0 : 1;
+    if (!error) {
+      *result = small_determinant(A->rows, a);
+    }
+  } else if (!error) {
+    error = result ? 0 : 1;
+    if (!error && spd_determinant(A, result)) {
+      error = det_by_lu(A, result);
+    }
+  }
+  STATS_END(S21_STAT_DETERMINANT,
+            error ? 0 : 2.0 / 3 * A->rows * A->rows * A->rows);
+  return error;
+}
+
+// The view is copied once into the LU storage, as s21_determinant copies A.
+int s21_determinant_view(s21_view_t *A, double *result) {
+  STATS_BEGIN(S21_STAT_DETERMINANT);
+  matrix_t copy = {0};
+  s21_lu_t lu = {0};
+  int error = check_bad_view(A);
   if (!error) {
-    error = det_by_lu(A, result);
+    error = A->rows == A->columns ? 0 : 2;
   }
+  if (!error && A->rows <= SMALL_ORDER) {
+    double a[SMALL_ORDER * SMALL_ORDER];
+    gather_view(A, a);
+    error = result ? 0 : 1;
+    if (!error) {
+      *result = small_determinant(A->rows, a);
+    }
+  } else if (!error) {
+    error = s21_view_copy(A, &copy);
+    if (!error) {
+      error = s21_lu_factor_inplace(&copy, &lu);
+    }
+    if (!error) {
+      error = s21_lu_det(&lu, result);
+    }
+  }
+  s21_remove_matrix(&copy);
+  s21_lu_remove(&lu);
+  STATS_END(S21_STAT_DETERMINANT,
+            error ? 0 : 2.0 / 3 * A->rows * A->rows * A->rows);
   return error;
 }
 
 int s21_inverse_matrix(matrix_t *A, matrix_t *result) {
-  double det;
-  int error = check_bad_matrix(A), n = A->rows;
-  matrix_t L, U;
-  int *p;
+  STATS_BEGIN(S21_STAT_INVERSE);
+  s21_lu_t lu = {0};
+  int error = check_bad_matrix(A);
   if (!error) {
     error = is_square(A) ? 0 : 2;
   }
+  if (!error && A->rows <= SMALL_ORDER) {
+    double a[SMALL_ORDER * SMALL_ORDER];
+    gather_small(A, a);
+    error = small_inverse(A->rows, a, a);
+    if (!error) {
+      error = s21_create_matrix(A->rows, A->rows, result);
+    }
+    if (!error) {
+      scatter_small(a, A->rows, result);
+    }
+  } else if (!error && spd_inverse(A, result)) {
+    error = s21_lu_factor(A, &lu);
+    if (!error) {
+      error = s21_lu_inverse(&lu, result);
+    }
+  }
+  s21_lu_remove(&lu);
+  STATS_END(S21_STAT_INVERSE, error ? 0 : 2.0 * A->rows * A->rows * A->rows);
+  return error;
+}
+
+int s21_lu_factor(matrix_t *A, s21_lu_t *lu) {
+  STATS_BEGIN(S21_STAT_LU_FACTOR);
+  int error = check_bad_matrix(A) || !lu, n = 0;
+  if (lu) {
+    lu->LU.matrix = NULL;
+    lu->p = NULL;
+    lu->swaps = 0;
+    lu->singular = 0;
+  }
   if (!error) {
-    error = create_L(&L, n) || create_U(A, &U, n) || create_p(&p, n);
+    n = A->rows;
+    error = is_square(A) ? 0 : 2;
   }
   if (!error) {
-    error = det_by_lu(A, &det);
-    error = det == 0 ? 2 : error;
+    error = create_LU(A, &lu->LU, n) ||
+            create_p(&lu->p, n, &lu->LU.allocator);
   }
   if (!error) {
-    matrix_t M, MT;
-    error = s21_calc_complements(A, &M) || s21_transpose(&M, &MT) ||
-            s21_mult_number(&MT, 1.0 / det, result);
-    s21_remove_matrix(&M);
-    s21_remove_matrix(&MT);
+    lu->singular = lu_decomposition(&lu->LU, lu->p, &lu->swaps);
+  } else {
+    s21_lu_remove(lu);
   }
-  s21_remove_matrix(&L);
-  s21_remove_matrix(&U);
-  remove_vector(&p);
+  STATS_END(S21_STAT_LU_FACTOR, error ? 0 : 2.0 / 3 * n * n * n);
   return error;
 }
 
-static int cycle_transpose_matrix(matrix_t *A, matrix_t *result) {
-  int error = 0;
-  for (int i = 0; i < A->rows && !error; i++) {
-    if (!(A->matrix[i])) {
-      error = 1;
-    }
-    for (int j = 0; j < A->columns && !error; j++) {
-      result->matrix[j][i] = A->matrix[i][j];
-    }
+int s21_lu_factor_inplace(matrix_t *A, s21_lu_t *lu) {
+  STATS_BEGIN(S21_STAT_LU_FACTOR);
+  int error = check_bad_matrix(A) || !lu, n = 0;
+  if (lu) {
+    lu->LU.matrix = NULL;
+    lu->p = NULL;
+    lu->swaps = 0;
+    lu->singular = 0;
+  }
+  if (!error) {
+    n = A->rows;
+    error = is_square(A) ? 0 : 2;
+  }
+  if (!error) {
+    error = create_p(&lu->p, n, &A->allocator);
+  }
+  if (!error) {
+    lu->LU = *A;
+    A->matrix = NULL;
+    A->rows = 0;
+    A->columns = 0;
+    lu->singular = lu_decomposition(&lu->LU, lu->p, &lu->swaps);
   }
+  STATS_END(S21_STAT_LU_FACTOR, error ? 0 : 2.0 / 3 * n * n * n);
   return error;
 }
 
-static int det_by_lu(matrix_t *A, double *det) {
-  matrix_t L, U;
-  int n = A->rows, error = 0, s = 0;
-  int *p;
-  error = create_L(&L, n) || create_U(A, &U, n) || create_p(&p, n);
-  if (!error) {
-    int singular = 0;
-    singular = lu_decomposition(n, &L, &U, p, &s);
-    if (singular) {
-      *det = 0;
-    } else {
-      *det = 1;
-      for (int i = 0; i < n; i++) {
-        *det *= U.matrix[i][i];
+int s21_lu_solve(s21_lu_t *lu, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_LU_SOLVE);
+  int error = check_bad_lu(lu) || check_bad_matrix(B);
+  if (!error) {
+    error = (B->rows != lu->LU.rows || lu->singular) ? 2 : 0;
+  }
+  if (!error) {
+    error = s21_create_matrix(B->rows, B->columns, result);
+  }
+  if (!error) {
+    for (int i = 0; i < B->rows; i++) {
+      for (int j = 0; j < B->columns; j++) {
+        result->matrix[i][j] = B->matrix[lu->p[i]][j];
       }
-      *det *= (s & 1 ? -1 : 1);
     }
+    s21_view_t factors = view_of(&lu->LU);
+    forward_substitution(&factors, 1, result);
+    back_substitution(&factors, result);
   }
-  s21_remove_matrix(&L);
-  s21_remove_matrix(&U);
-  remove_vector(&p);
+  STATS_END(S21_STAT_LU_SOLVE, error ? 0 : 2.0 * B->rows * B->rows * B->columns);
   return error;
 }
 
-static int create_L(matrix_t *L, int n) {
-  int error = 0;
-  error = s21_create_matrix(n, n, L);
+int s21_solve(matrix_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SOLVE);
+  s21_lu_t lu = {0};
+  int error = check_bad_matrix(B);
+  if (!error) {
+    error = s21_lu_factor(A, &lu);
+  }
   if (!error) {
+    error = s21_lu_solve(&lu, B, result);
+  }
+  s21_lu_remove(&lu);
+  STATS_END(S21_STAT_SOLVE,
+            error ? 0
+                  : 2.0 / 3 * A->rows * A->rows * A->rows +
+                        2.0 * B->rows * B->rows * B->columns);
+  return error;
+}
+
+int s21_lu_det(s21_lu_t *lu, double *result) {
+  STATS_BEGIN(S21_STAT_LU_DET);
+  int error = check_bad_lu(lu) || !result;
+  if (!error && lu->singular) {
+    *result = 0;
+  } else if (!error) {
+    *result = 1;
+    for (int i = 0; i < lu->LU.rows; i++) {
+      *result *= lu->LU.matrix[i][i];
+    }
+    *result *= (lu->swaps & 1 ? -1 : 1);
+  }
+  STATS_END(S21_STAT_LU_DET, error ? 0 : lu->LU.rows);
+  return error;
+}
+
+int s21_lu_inverse(s21_lu_t *lu, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_LU_INVERSE);
+  int error = check_bad_lu(lu), n = 0;
+  if (!error) {
+    n = lu->LU.rows;
+    error = lu->singular ? 2 : 0;
+  }
+  if (!error) {
+    error = s21_create_matrix(n, n, result);
+  }
+  if (!error) {
+    init_permutation(result, lu->p, n);
+    s21_view_t factors = view_of(&lu->LU);
+    forward_substitution(&factors, 1, result);
+    back_substitution(&factors, result);
+  }
+  STATS_END(S21_STAT_LU_INVERSE, error ? 0 : 4.0 / 3 * n * n * n);
+  return error;
+}
+
+void s21_lu_remove(s21_lu_t *lu) {
+  if (lu) {
+    remove_vector(&lu->p, &lu->LU.allocator);
+    s21_remove_matrix(&lu->LU);
+    lu->swaps = 0;
+    lu->singular = 0;
+  }
+}
+
+// Threads take whole rows of tiles, so each writes its own columns of the
+// result.
+static int cycle_transpose_matrix(matrix_t *A, matrix_t *result) {
+  transpose_t args = {A, result};
+  int tiles = (A->rows + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+  int grain = TRANSPOSE_GRAIN / (TRANSPOSE_TILE * A->columns) + 1;
+  parallel_for(tiles, grain, transpose_tiles, &args);
+  return 0;
+}
+
+static void transpose_tiles(void *arg, int begin, int end) {
+  transpose_t *args = arg;
+  int rows = args->A->rows, columns = args->A->columns;
+  for (int i0 = begin * TRANSPOSE_TILE; i0 < end * TRANSPOSE_TILE && i0 < rows;
+       i0 += TRANSPOSE_TILE) {
+    int i1 = i0 + TRANSPOSE_TILE < rows ? i0 + TRANSPOSE_TILE : rows;
+    for (int j0 = 0; j0 < columns; j0 += TRANSPOSE_TILE) {
+      int j1 = j0 + TRANSPOSE_TILE < columns ? j0 + TRANSPOSE_TILE : columns;
+      transpose_tile(args->A->matrix, args->result->matrix, i0, i1, j0, j1);
+    }
+  }
+}
+
+static void transpose_tile(double **a, double **r, int i0, int i1, int j0,
+                           int j1) {
+  void (*kernel)(double *const *, int, double *const *, int) =
+      simd_kernels()->transpose_4x4;
+  int i = i0;
+  for (; i + 4 <= i1; i += 4) {
+    int j = j0;
+    for (; j + 4 <= j1; j += 4) {
+      kernel(a + i, j, r + j, i);
+    }
+    for (; j < j1; j++) {
+      for (int l = i; l < i + 4; l++) {
+        r[j][l] = a[l][j];
+      }
+    }
+  }
+  for (; i < i1; i++) {
+    for (int j = j0; j < j1; j++) {
+      r[j][i] = a[i][j];
+    }
+  }
+}
+
+// Covers the leading multiple-of-4 square only. A row of tiles swaps its
+// tiles on and right of the diagonal with their mirror images, so no two
+// threads touch the same element.
+static void transpose_tiles_inplace(void *arg, int begin, int end) {
+  transpose_t *args = arg;
+  double **a = args->A->matrix;
+  int n4 = args->A->rows & ~3;
+  for (int i0 = begin * TRANSPOSE_TILE; i0 < end * TRANSPOSE_TILE && i0 < n4;
+       i0 += TRANSPOSE_TILE) {
+    int i1 = i0 + TRANSPOSE_TILE < n4 ? i0 + TRANSPOSE_TILE : n4;
+    for (int j0 = i0; j0 < n4; j0 += TRANSPOSE_TILE) {
+      int j1 = j0 + TRANSPOSE_TILE < n4 ? j0 + TRANSPOSE_TILE : n4;
+      for (int i = i0; i < i1; i += 4) {
+        for (int j = j0 > i ? j0 : i; j < j1; j += 4) {
+          swap_blocks(a, i, j);
+        }
+      }
+    }
+  }
+}
+
+// Exchanges the 4 x 4 block at (i, j) with the transpose of the one at
+// (j, i); for i == j this transposes the diagonal block itself.
+static void swap_blocks(double **a, int i, int j) {
+  void (*kernel)(double *const *, int, double *const *, int) =
+      simd_kernels()->transpose_4x4;
+  double tmp[4][4];
+  double *t[4] = {tmp[0], tmp[1], tmp[2], tmp[3]};
+  kernel(a + i, j, t, 0);
+  if (i != j) {
+    kernel(a + j, i, a + i, j);
+  }
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 4; c++) {
+      a[j + r][i + c] = tmp[r][c];
+    }
+  }
+}
+
+// Allocation-free factorization for callers that keep their own scratch:
+// M is factored in place with p as its permutation and, if inverse is
+// given, inverse is overwritten with M^-1. Returns 1 for a singular M.
+int lu_scratch(matrix_t *M, int *p, double *det, matrix_t *inverse) {
+  int n = M->rows, swaps = 0;
+  for (int i = 0; i < n; i++) {
+    p[i] = i;
+  }
+  int singular = lu_decomposition(M, p, &swaps);
+  *det = singular ? 0 : (swaps & 1 ? -1 : 1);
+  for (int i = 0; i < n && !singular; i++) {
+    *det *= M->matrix[i][i];
+  }
+  if (inverse && !singular) {
     for (int i = 0; i < n; i++) {
-      L->matrix[i][i] = 1;
+      memset(inverse->matrix[i], 0, n * sizeof(double));
     }
+    init_permutation(inverse, p, n);
+    s21_view_t factors = view_of(M);
+    forward_substitution(&factors, 1, inverse);
+    back_substitution(&factors, inverse);
+  }
+  return singular;
+}
+
+static int det_by_lu(matrix_t *A, double *det) {
+  s21_lu_t lu;
+  int error = s21_lu_factor(A, &lu);
+  if (!error) {
+    error = s21_lu_det(&lu, det);
+  }
+  s21_lu_remove(&lu);
+  return error;
+}
+
+static int check_bad_lu(s21_lu_t *lu) {
+  int error = 0;
+  if (!lu || !(lu->p) || check_bad_matrix(&lu->LU)) {
+    error = 1;
   }
   return error;
 }
 
-static int create_U(matrix_t *A, matrix_t *U, int n) {
+static int create_LU(matrix_t *A, matrix_t *LU, int n) {
   int error = 0;
-  error = s21_create_matrix(n, n, U);
+  error = s21_create_matrix(n, n, LU);
   if (!error) {
     for (int i = 0; i < n; i++) {
       for (int j = 0; j < n; j++) {
-        U->matrix[i][j] = A->matrix[i][j];
+        LU->matrix[i][j] = A->matrix[i][j];
       }
     }
   }
   return error;
 }
 
-static int create_p(int **p, int n) {
+// The permutation lives with the LU matrix, under the same allocator.
+static int create_p(int **p, int n, s21_allocator_t *allocator) {
   int error = 0;
-  *p = NULL;
-  *p = malloc(n * sizeof(int));
+  *p = allocator->alloc(allocator->ctx, n * sizeof(int), _Alignof(int));
   if (!*p) {
     error = 1;
   } else {
+    STATS_ALLOC(n * sizeof(int));
     for (int i = 0; i < n; i++) {
       (*p)[i] = i;
     }
@@ -182,53 +606,106 @@ static int create_p(int **p, int n) {
   return error;
 }
 
-static void remove_vector(int **p) { free(*p); }
+static void remove_vector(int **p, s21_allocator_t *allocator) {
+  if (*p) {
+    allocator->free(allocator->ctx, *p);
+  }
+  *p = NULL;
+}
+
+// lu_decomposition, forward_substitution and back_substitution with their
+// helpers, shared with the float LU.
+#define SCALAR double
+#define SCALAR_NAME(name) name
+#define SCALAR_MATRIX matrix_t
+#define SCALAR_VIEW s21_view_t
+#define SCALAR_VIEW_OF view_of
+#define SCALAR_VIEW_AT view_at
+#define SCALAR_VIEW_BLOCK view_block
+#define LU_GEMM_UPDATE gemm_update
+#define LU_LINKAGE
+#include "s21_lu.inc"
 
-static int lu_decomposition(int n, matrix_t *L, matrix_t *U, int *p, int *s) {
-  int singular = 0;
-  for (int k = 0; k < n - 1; k++) {
-    int max_elem_i = k;
-    for (int i = k + 1; i < n; i++) {
-      if (fabs(U->matrix[i][k]) > fabs(U->matrix[max_elem_i][k])) {
-        max_elem_i = i;
+// P * M * Q = L * U packed like lu_decomposition, with the largest
+// remaining element as each pivot. Unblocked, as only singular matrices
+// come here. Stops at the first zero pivot and returns the rank.
+static int complete_pivoting(matrix_t *M, int *p, int *q, int *s) {
+  double **m = M->matrix;
+  int n = M->rows, rank = 0;
+  for (int k = 0; k < n && rank == k; k++) {
+    int r = k, c = k;
+    for (int i = k; i < n; i++) {
+      for (int j = k; j < n; j++) {
+        if (fabs(m[i][j]) > fabs(m[r][c])) {
+          r = i;
+          c = j;
+        }
       }
     }
-    if (max_elem_i != k) {
-      perm(U, p, s, n, max_elem_i, k);
-    }
-    if (U->matrix[k][k] == 0) {
-      singular = 1;
-    }
-    for (int i = k + 1; i < n && !singular; i++) {
-      double factor = U->matrix[i][k] / U->matrix[k][k];
-      L->matrix[i][k] = factor;
-      for (int j = 0; j < k; j++) {
-        U->matrix[i][j] = 0;
+    if (m[r][c] != 0) {
+      rank++;
+      if (r != k) {
+        swap_rows(M, p, s, r, k);
       }
-      for (int j = k; j < n; j++) {
-        U->matrix[i][j] -= U->matrix[k][j] * factor;
+      if (c != k) {
+        swap_columns(M, q, s, c, k);
+      }
+      for (int i = k + 1; i < n; i++) {
+        double factor = m[i][k] / m[k][k];
+        m[i][k] = factor;
+        for (int j = k + 1; j < n; j++) {
+          m[i][j] -= m[k][j] * factor;
+        }
       }
     }
   }
-  if (U->matrix[n - 1][n - 1] == 0) {
-    singular = 1;
-  }
-  return singular;
+  return rank;
 }
 
-static void perm(matrix_t *U, int *p, int *s, int n, int r1, int r2) {
-  double temp_double;
-  for (int j = 0; j < n; j++) {
-    temp_double = U->matrix[r1][j];
-    U->matrix[r1][j] = U->matrix[r2][j];
-    U->matrix[r2][j] = temp_double;
+static void swap_columns(matrix_t *M, int *q, int *s, int c1, int c2) {
+  for (int i = 0; i < M->rows; i++) {
+    double temp = M->matrix[i][c1];
+    M->matrix[i][c1] = M->matrix[i][c2];
+    M->matrix[i][c2] = temp;
   }
-  int temp_int = p[r1];
-  p[r1] = p[r2];
-  p[r2] = temp_int;
+  int temp_int = q[c1];
+  q[c1] = q[c2];
+  q[c2] = temp_int;
   (*s)++;
 }
 
+// X = P, so solving L * U * X = P gives X = A^-1 for P * A = L * U.
+static void init_permutation(matrix_t *X, int *p, int n) {
+  for (int i = 0; i < n; i++) {
+    X->matrix[i][p[i]] = 1;
+  }
+}
+
+// Packs a matrix of order <= SMALL_ORDER row-major for the closed forms.
+static void gather_small(matrix_t *A, double *a) {
+  for (int i = 0; i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      a[i * A->columns + j] = A->matrix[i][j];
+    }
+  }
+}
+
+static void gather_view(const s21_view_t *A, double *a) {
+  for (int i = 0; i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      a[i * A->columns + j] = *view_at(A, i, j);
+    }
+  }
+}
+
+static void scatter_small(const double *a, int n, matrix_t *result) {
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      result->matrix[i][j] = a[i * n + j];
+    }
+  }
+}
+
 static int is_square(matrix_t *A) {
   int result = 0;
   if (A->columns == A->rows) {
@@ -1,47 +1,95 @@
 #include "s21_matrix.h"
 
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
+
+static int create_storage(int rows, int columns, int ld, size_t align,
+                          const s21_allocator_t *allocator, matrix_t *result);
 
 int s21_create_matrix(int rows, int columns, matrix_t *result) {
+  return s21_create_matrix_with(rows, columns, NULL, result);
+}
+
+int s21_create_matrix_with(int rows, int columns,
+                           const s21_allocator_t *allocator, matrix_t *result) {
+  return create_storage(rows, columns, columns, _Alignof(double), allocator,
+                        result);
+}
+
+int s21_create_matrix_aligned(int rows, int columns, matrix_t *result) {
+  int pad = S21_ALIGNMENT / sizeof(double);
+  int ld = columns;
+  if (columns > 0 && columns <= INT_MAX - pad) {
+    ld = (columns + pad - 1) / pad * pad;
+  }
+  return create_storage(rows, columns, ld, S21_ALIGNMENT, NULL, result);
+}
+
+// A matrix without a free callback was not made by s21_create_matrix*; it
+// is taken to be malloc'd rows over one block at matrix[0], as before the
+// allocator existed.
+void s21_remove_matrix(matrix_t *A) {
+  if (A && A->matrix) {
+    s21_allocator_t *a = &A->allocator;
+    if (!a->free) {
+      free(A->matrix[0]);
+      free(A->matrix);
+    } else {
+      if (A->data) {
+        a->free(a->ctx, A->data);
+      }
+      a->free(a->ctx, A->matrix);
+    }
+    A->data = NULL;
+    A->matrix = NULL;
+    A->rows = 0;
+    A->columns = 0;
+    A->ld = 0;
+  }
+}
+
+static int create_storage(int rows, int columns, int ld, size_t align,
+                          const s21_allocator_t *allocator, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_CREATE);
   int error = 0;
   double *data = NULL;
+  s21_allocator_t *a = &result->allocator;
   result->matrix = NULL;
+  result->data = NULL;
+  result->ld = 0;
+  *a = allocator ? *allocator : *s21_get_allocator();
   if (rows <= 0 || columns <= 0) {
     error = 1;
   }
   if (!error) {
-    result->matrix = malloc(rows * sizeof(double *));
+    result->matrix =
+        a->alloc(a->ctx, rows * sizeof(double *), _Alignof(double *));
     if (!(result->matrix)) {
       error = 1;
     }
   }
   if (!error) {
-    data = calloc(rows * columns, sizeof(double));
+    size_t size = (size_t)rows * ld * sizeof(double);
+    data = a->alloc(a->ctx, size, align);
     if (!data) {
       error = 1;
-      free(result->matrix);
+      a->free(a->ctx, result->matrix);
       result->matrix = NULL;
+    } else {
+      memset(data, 0, size);
+      STATS_ALLOC(size + rows * sizeof(double *));
     }
   }
   if (!error) {
     for (int i = 0; i < rows; i++) {
-      result->matrix[i] = data + i * columns;
+      result->matrix[i] = data + (size_t)i * ld;
     }
+    result->data = data;
+    result->ld = ld;
     result->rows = rows;
     result->columns = columns;
   }
+  STATS_END(S21_STAT_CREATE, 0);
   return error;
 }
-
-void s21_remove_matrix(matrix_t *A) {
-  if (A && A->matrix) {
-    if (A->matrix[0]) {
-      free(A->matrix[0]);
-      A->matrix[0] = NULL;
-    }
-    free(A->matrix);
-    A->matrix = NULL;
-    A->rows = 0;
-    A->columns = 0;
-  }
-}
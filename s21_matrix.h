@@ -1,14 +1,89 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <stddef.h>
+
+// Storage callbacks. alloc returns a block of size bytes aligned to align
+// (a power of two) or NULL; free gets back the blocks alloc handed out.
+typedef struct allocator_struct {
+  void *(*alloc)(void *ctx, size_t size, size_t align);
+  void (*free)(void *ctx, void *ptr);
+  void *ctx;
+} s21_allocator_t;
+
+// matrix[i] points at row i of one block: data + i * ld. ld equals columns
+// unless the matrix was created aligned, in which case rows are padded.
 typedef struct matrix_struct {
   double **matrix;
   int rows;
   int columns;
+  s21_allocator_t allocator;
+  double *data;
+  int ld;
 } matrix_t;
 
+// s21_create_matrix uses the allocator installed by s21_set_allocator,
+// malloc and free by default. Each matrix keeps the allocator it was made
+// with, so s21_remove_matrix always frees through the right one. Matrices
+// must come from s21_create_matrix*; a struct filled in by hand should at
+// least zero allocator, and is then freed as malloc'd rows over one block
+// starting at matrix[0].
 int s21_create_matrix(int rows, int columns, matrix_t *result);
+int s21_create_matrix_with(int rows, int columns,
+                           const s21_allocator_t *allocator, matrix_t *result);
+// data starts on an S21_ALIGNMENT boundary and ld is rounded up to a whole
+// number of such blocks, so every row starts on a cache line.
+#define S21_ALIGNMENT 64
+int s21_create_matrix_aligned(int rows, int columns, matrix_t *result);
 void s21_remove_matrix(matrix_t *A);
+void s21_set_allocator(const s21_allocator_t *allocator);
+const s21_allocator_t *s21_get_allocator(void);
+
+// Binary matrix files: a 64-byte header (magic, version, dtype, byte
+// order, row alignment, rows, columns, ld) followed by the rows, row-major
+// with a stride of ld elements. s21_mmap_matrix wires the row pointers
+// straight into a private mapping of the file, so loading copies nothing;
+// s21_remove_matrix unmaps it. Files that do not match this build's
+// version, dtype or byte order are rejected with 1.
+#define S21_FILE_VERSION 1
+#define S21_DTYPE_FLOAT64 1
+int s21_save_matrix(matrix_t *A, const char *path);
+int s21_mmap_matrix(const char *path, matrix_t *result);
+
+// A matrix file worked on in place, for matrices larger than memory.
+// Tiles are copied in and out with pread/pwrite and must lie inside the
+// matrix; s21_tiled_mult keeps 5 tile x tile blocks in memory, and
+// s21_tiled_lu 3 blocks of rows x tile. Both read the next tile on a
+// helper thread while computing on the current one.
+typedef struct tiled_struct {
+  int fd;
+  int rows;
+  int columns;
+  int ld;
+} s21_tiled_t;
+
+int s21_tiled_open(const char *path, s21_tiled_t *result);
+int s21_tiled_create(const char *path, int rows, int columns,
+                     s21_tiled_t *result);
+void s21_tiled_close(s21_tiled_t *A);
+int s21_tiled_read(s21_tiled_t *A, int row, int column, matrix_t *tile);
+int s21_tiled_write(s21_tiled_t *A, int row, int column, matrix_t *tile);
+int s21_tiled_mult(s21_tiled_t *A, s21_tiled_t *B, s21_tiled_t *result,
+                   int tile);
+int s21_tiled_lu(s21_tiled_t *A, int tile, int *p, int *singular);
+
+// Bump allocator over one malloc'd block. Its free is a no-op: temporaries
+// are all released at once by s21_arena_reset.
+typedef struct arena_struct {
+  char *base;
+  size_t size;
+  size_t used;
+} s21_arena_t;
+
+int s21_arena_init(s21_arena_t *arena, size_t size);
+s21_allocator_t s21_arena_allocator(s21_arena_t *arena);
+void s21_arena_reset(s21_arena_t *arena);
+void s21_arena_destroy(s21_arena_t *arena);
 
 #define SUCCESS 1
 #define FAILURE 0
@@ -20,15 +95,370 @@ int s21_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
 int s21_mult_number(matrix_t *A, double number, matrix_t *result);
 int s21_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
 
+// Same operations written into an existing result of the right size, so a
+// loop can reuse one matrix instead of allocating a new one per step.
+// Elementwise results may be one of the operands; a product's may not.
+int s21_sum_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result);
+int s21_sub_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result);
+int s21_mult_number_into(matrix_t *A, double number, matrix_t *result);
+int s21_mult_matrix_into(matrix_t *A, matrix_t *B, matrix_t *result);
+// A += B, A -= B and A *= number.
+int s21_sum_inplace(matrix_t *A, matrix_t *B);
+int s21_sub_inplace(matrix_t *A, matrix_t *B);
+int s21_mult_number_inplace(matrix_t *A, double number);
+// Fused updates of an existing matrix, one pass and no temporaries:
+// C = alpha * A * B + beta * C (BLAS gemm) and Y = alpha * X + beta * Y.
+// As in BLAS, beta = 0 ignores what C or Y held, NaN included, and
+// alpha = 0 skips the product. C may not overlap A or B; X may be Y.
+// alpha * A * B + beta * C - D is s21_gemm followed by
+// s21_axpby(-1, D, 1, C).
+int s21_gemm(double alpha, matrix_t *A, matrix_t *B, double beta,
+             matrix_t *C);
+int s21_axpby(double alpha, matrix_t *X, double beta, matrix_t *Y);
+
 int s21_transpose(matrix_t *A, matrix_t *result);
+int s21_transpose_into(matrix_t *A, matrix_t *result);
+// Square matrices only; nothing is allocated.
+int s21_transpose_inplace(matrix_t *A);
+
+// Unchecked versions of the _into functions for hot loops: nothing is
+// validated, allocated or scanned row by row. Every matrix must come from
+// s21_create_matrix (or a variant) with its rows left in place, shapes
+// must match, and the results of products and transposes must not overlap
+// their operands. Anything else is undefined behaviour.
+int s21_fast_eq(matrix_t *A, matrix_t *B);
+void s21_fast_sum(matrix_t *A, matrix_t *B, matrix_t *result);
+void s21_fast_sub(matrix_t *A, matrix_t *B, matrix_t *result);
+void s21_fast_mult_number(matrix_t *A, double number, matrix_t *result);
+void s21_fast_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result);
+void s21_fast_transpose(matrix_t *A, matrix_t *result);
 
 int s21_calc_complements(matrix_t *A, matrix_t *result);
 
+// Window into another matrix's storage; nothing is copied. Element (i, j) is
+// matrix[row + i * row_step][column + j * column_step], with i and j swapped
+// when transposed. rows and columns are the sizes seen through the view.
+// A view stays valid only as long as the matrix it was made from.
+typedef struct view_struct {
+  double **matrix;
+  int row;
+  int column;
+  int rows;
+  int columns;
+  int row_step;
+  int column_step;
+  int transposed;
+} s21_view_t;
+
+int s21_view_matrix(matrix_t *A, s21_view_t *view);
+int s21_view_block(matrix_t *A, int row, int column, int rows, int columns,
+                   s21_view_t *view);
+int s21_view_strided(matrix_t *A, int row, int column, int rows, int columns,
+                     int row_step, int column_step, s21_view_t *view);
+void s21_view_transpose(s21_view_t *view);
+int s21_view_copy(s21_view_t *view, matrix_t *result);
+int s21_eq_view(s21_view_t *A, s21_view_t *B);
+int s21_sum_view(s21_view_t *A, s21_view_t *B, matrix_t *result);
+int s21_sub_view(s21_view_t *A, s21_view_t *B, matrix_t *result);
+int s21_mult_number_view(s21_view_t *A, double number, matrix_t *result);
+int s21_mult_matrix_view(s21_view_t *A, s21_view_t *B, matrix_t *result);
+int s21_determinant_view(s21_view_t *A, double *result);
+
 int s21_determinant(matrix_t *A, double *result);
 
 int s21_inverse_matrix(matrix_t *A, matrix_t *result);
 
+// Fixed-size matrices that live on the stack, indexed m[row][column]. The
+// closed forms behind them allocate nothing and also serve the matrix_t
+// entry points for orders up to 4. Singular inverses return 2.
+typedef struct mat2_struct {
+  double m[2][2];
+} s21_mat2_t;
+
+typedef struct mat3_struct {
+  double m[3][3];
+} s21_mat3_t;
+
+typedef struct mat4_struct {
+  double m[4][4];
+} s21_mat4_t;
+
+int s21_mat2_determinant(const s21_mat2_t *A, double *result);
+int s21_mat2_inverse(const s21_mat2_t *A, s21_mat2_t *result);
+int s21_mat2_complements(const s21_mat2_t *A, s21_mat2_t *result);
+int s21_mat3_determinant(const s21_mat3_t *A, double *result);
+int s21_mat3_inverse(const s21_mat3_t *A, s21_mat3_t *result);
+int s21_mat3_complements(const s21_mat3_t *A, s21_mat3_t *result);
+int s21_mat4_determinant(const s21_mat4_t *A, double *result);
+int s21_mat4_inverse(const s21_mat4_t *A, s21_mat4_t *result);
+int s21_mat4_complements(const s21_mat4_t *A, s21_mat4_t *result);
+
+// P * A = L * U with partial pivoting; row i of P * A is row p[i] of A.
+// LU is packed like LAPACK getrf: U on and above the diagonal, the unit
+// lower L below it. Factor once, then reuse for solves, det or inverse.
+// Pivoting swaps LU's row pointers, so its rows are reached through
+// LU.matrix only; the s21_fast_* functions do not accept it.
+typedef struct lu_struct {
+  matrix_t LU;
+  int *p;
+  int swaps;
+  int singular;
+} s21_lu_t;
+
+int s21_lu_factor(matrix_t *A, s21_lu_t *lu);
+// Factors A's own storage without a copy; lu takes it over and A is emptied.
+int s21_lu_factor_inplace(matrix_t *A, s21_lu_t *lu);
+int s21_lu_solve(s21_lu_t *lu, matrix_t *B, matrix_t *result);
+int s21_lu_det(s21_lu_t *lu, double *result);
+int s21_lu_inverse(s21_lu_t *lu, matrix_t *result);
+void s21_lu_remove(s21_lu_t *lu);
+// X with A * X = B for every column of B at once, through the LU of A.
+int s21_solve(matrix_t *A, matrix_t *B, matrix_t *result);
+
+// A = L * L^T for a symmetric positive-definite A, reading only A's lower
+// triangle; L has zeros above the diagonal. Returns 2 when A is not square
+// or not positive definite. The other functions take that L. For n > 4,
+// s21_determinant and s21_inverse_matrix try this path on their own when
+// A is exactly symmetric with a positive diagonal.
+int s21_cholesky(matrix_t *A, matrix_t *result);
+int s21_cholesky_solve(matrix_t *L, matrix_t *B, matrix_t *result);
+int s21_cholesky_det(matrix_t *L, double *result);
+int s21_cholesky_inverse(matrix_t *L, matrix_t *result);
+
+// Single precision: matrix_t's layout with float elements, half the memory
+// and twice the elements per SIMD register. The functions mirror their
+// double namesakes, error codes included; s21_eq_matrix_f compares to 1e-6,
+// about the precision float keeps. s21_to_float and s21_to_double convert
+// into new matrices.
+typedef struct matrix_f_struct {
+  float **matrix;
+  int rows;
+  int columns;
+  s21_allocator_t allocator;
+  float *data;
+  int ld;
+} matrix_f_t;
+
+int s21_create_matrix_f(int rows, int columns, matrix_f_t *result);
+void s21_remove_matrix_f(matrix_f_t *A);
+int s21_to_float(matrix_t *A, matrix_f_t *result);
+int s21_to_double(matrix_f_t *A, matrix_t *result);
+int s21_eq_matrix_f(matrix_f_t *A, matrix_f_t *B);
+int s21_sum_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result);
+int s21_sub_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result);
+int s21_mult_number_f(matrix_f_t *A, float number, matrix_f_t *result);
+int s21_mult_matrix_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result);
+int s21_transpose_f(matrix_f_t *A, matrix_f_t *result);
+int s21_calc_complements_f(matrix_f_t *A, matrix_f_t *result);
+int s21_determinant_f(matrix_f_t *A, float *result);
+int s21_inverse_matrix_f(matrix_f_t *A, matrix_f_t *result);
+
+// Packed and pivoted like s21_lu_t.
+typedef struct lu_f_struct {
+  matrix_f_t LU;
+  int *p;
+  int swaps;
+  int singular;
+} s21_lu_f_t;
+
+int s21_lu_factor_f(matrix_f_t *A, s21_lu_f_t *lu);
+int s21_lu_solve_f(s21_lu_f_t *lu, matrix_f_t *B, matrix_f_t *result);
+void s21_lu_remove_f(s21_lu_f_t *lu);
+int s21_solve_f(matrix_f_t *A, matrix_f_t *B, matrix_f_t *result);
+// s21_solve's result to double accuracy from a float factorization: the
+// residual B - A * X is taken in double and corrected through the float
+// LU until it is at rounding level. When float cannot get there (A is
+// singular or too ill-conditioned in float), A is factored in double.
+// Each step costs a product with B, so it pays for few columns of B.
+int s21_solve_mixed(matrix_t *A, matrix_t *B, matrix_t *result);
+
+// count matrices of rows x columns in one buffer: matrix b is stored
+// row-major without padding at data + b * stride, stride >= rows * columns.
+// Callers may fill the struct around their own buffer; only batches from
+// s21_batch_create are released with s21_batch_remove.
+typedef struct batch_struct {
+  double *data;
+  int count;
+  int rows;
+  int columns;
+  long stride;
+  s21_allocator_t allocator;
+} s21_batch_t;
+
+int s21_batch_create(int count, int rows, int columns, s21_batch_t *result);
+void s21_batch_remove(s21_batch_t *A);
+// One call for the whole batch; results may share the input's buffer.
+// Singular matrices get a zero inverse and make the call return 2.
+int s21_batch_determinant(s21_batch_t *A, double *result);
+int s21_batch_inverse(s21_batch_t *A, s21_batch_t *result);
+int s21_batch_mult(s21_batch_t *A, s21_batch_t *B, s21_batch_t *result);
+
+// Compressed sparse rows: row i holds the nonzeros values[row_start[i]] to
+// values[row_start[i + 1] - 1], sorted by their column_index. Storage
+// grows with nnz, never with rows * columns; capacity is the room
+// allocated for nonzeros.
+typedef struct sparse_struct {
+  double *values;
+  int *column_index;
+  int *row_start;
+  int rows;
+  int columns;
+  int nnz;
+  int capacity;
+  s21_allocator_t allocator;
+} s21_sparse_t;
+
+int s21_sparse_create(int rows, int columns, int capacity,
+                      s21_sparse_t *result);
+void s21_sparse_remove(s21_sparse_t *A);
+int s21_sparse_from_dense(matrix_t *A, s21_sparse_t *result);
+int s21_sparse_to_dense(s21_sparse_t *A, matrix_t *result);
+// count entries (row[k], column[k], value[k]) in any order; repeats add up.
+int s21_sparse_from_triplets(int rows, int columns, int count,
+                             const int *row, const int *column,
+                             const double *value, s21_sparse_t *result);
+// The CSR arrays of A^T are the compressed columns of A.
+int s21_sparse_transpose(s21_sparse_t *A, s21_sparse_t *result);
+int s21_sparse_sum(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result);
+int s21_sparse_sub(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result);
+int s21_sparse_mult_dense(s21_sparse_t *A, matrix_t *B, matrix_t *result);
+int s21_sparse_mult(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result);
+
+// P * A * Q = L * U, with Q a reverse Cuthill-McKee order that keeps the
+// fill near the diagonal and threshold partial pivoting that prefers it.
+// Row k of P * A is row p[k] of A, column k of A * Q is column q[k] of A.
+// L and U are stored by columns: row k of each holds column k, L without
+// its unit diagonal and U with its pivot last. As with s21_lu_t, a
+// singular A still factors but cannot be solved.
+typedef struct sparse_lu_struct {
+  s21_sparse_t L;
+  s21_sparse_t U;
+  int *p;
+  int *q;
+  int singular;
+} s21_sparse_lu_t;
+
+int s21_sparse_lu_factor(s21_sparse_t *A, s21_sparse_lu_t *lu);
+int s21_sparse_lu_solve(s21_sparse_lu_t *lu, matrix_t *B, matrix_t *result);
+int s21_sparse_lu_det(s21_sparse_lu_t *lu, double *result);
+void s21_sparse_lu_remove(s21_sparse_lu_t *lu);
+int s21_sparse_determinant(s21_sparse_t *A, double *result);
+int s21_sparse_solve(s21_sparse_t *A, matrix_t *B, matrix_t *result);
+
+// Threads used by large products, factorizations and elementwise ops.
+// Defaults to the S21_NUM_THREADS environment variable, or 1 if unset.
+void s21_set_num_threads(int n);
+int s21_get_num_threads(void);
+
+// Instruction set used by the vector kernels, detected with cpuid on first
+// use. S21_SIMD=scalar|sse2|avx2 in the environment or s21_set_simd_level
+// can only lower it; the level actually selected is returned.
+#define S21_SIMD_SCALAR 0
+#define S21_SIMD_SSE2 1
+#define S21_SIMD_AVX2 2
+#define S21_SIMD_AVX512 3
+int s21_simd_level(void);
+int s21_set_simd_level(int level);
+
+// Per-operation counters, recorded only when the library is built with
+// -DS21_STATS; otherwise the queries report zeros and calls cost nothing
+// extra. Variants (_into, _inplace, _view, _with, _aligned) count under
+// their base operation. Time and bytes are inclusive: a determinant taken
+// inside s21_calc_complements shows up under both.
+#define S21_STAT_CREATE 0
+#define S21_STAT_EQ 1
+#define S21_STAT_SUM 2
+#define S21_STAT_SUB 3
+#define S21_STAT_MULT_NUMBER 4
+#define S21_STAT_MULT_MATRIX 5
+#define S21_STAT_TRANSPOSE 6
+#define S21_STAT_CALC_COMPLEMENTS 7
+#define S21_STAT_DETERMINANT 8
+#define S21_STAT_INVERSE 9
+#define S21_STAT_LU_FACTOR 10
+#define S21_STAT_LU_SOLVE 11
+#define S21_STAT_LU_DET 12
+#define S21_STAT_LU_INVERSE 13
+#define S21_STAT_SOLVE 14
+#define S21_STAT_CHOLESKY 15
+#define S21_STAT_CHOLESKY_SOLVE 16
+#define S21_STAT_SPARSE_MULT 17
+#define S21_STAT_SPARSE_LU_FACTOR 18
+#define S21_STAT_SPARSE_LU_SOLVE 19
+#define S21_STAT_GEMM 20
+#define S21_STAT_AXPBY 21
+#define S21_STAT_SOLVE_MIXED 22
+#define S21_STAT_COUNT 23
+
+typedef struct stats_struct {
+  long long calls;
+  double flops;
+  long long bytes;
+  double seconds;
+} s21_stats_t;
+
+// Called on entry to and exit from every counted operation.
+typedef void (*s21_stats_hook)(int id, void *user);
+
+int s21_stats_enabled(void);
+const char *s21_stats_name(int id);
+int s21_stats_get(int id, s21_stats_t *stats);
+void s21_stats_reset(void);
+void s21_stats_set_hooks(s21_stats_hook begin, s21_stats_hook end,
+                         void *user);
+
 int check_bad_matrix(matrix_t *A);
+int is_contiguous(matrix_t *A);
+int check_aliasing(matrix_t *A, matrix_t *result);
+int check_bad_view(s21_view_t *view);
+s21_view_t view_of(matrix_t *A);
+double *view_at(const s21_view_t *view, int i, int j);
+s21_view_t view_block(const s21_view_t *view, int i, int j, int rows,
+                      int columns);
+void gemm_update(double alpha, const s21_view_t *a, const s21_view_t *b,
+                 double **c, int cc);
+int lu_scratch(matrix_t *M, int *p, double *det, matrix_t *inverse);
+int lu_decomposition(matrix_t *LU, int *p, int *s);
+void forward_substitution(const s21_view_t *L, int unit, matrix_t *X);
+void back_substitution(const s21_view_t *U, matrix_t *X);
+int is_refined(matrix_t *R, matrix_t *X, double bound);
+int cholesky_factor(matrix_t *A, matrix_t *L);
+int spd_determinant(matrix_t *A, double *det);
+int spd_inverse(matrix_t *A, matrix_t *result);
+#define SMALL_ORDER 4
+double small_determinant(int n, const double *a);
+int small_inverse(int n, const double *a, double *result);
+void small_complements(int n, const double *a, double *result);
+typedef void (*parallel_fn)(void *arg, int begin, int end);
+void parallel_for(int n, int grain, parallel_fn fn, void *arg);
+typedef struct simd_kernels_struct {
+  void (*add)(const double *a, const double *b, double *c, long n);
+  void (*sub)(const double *a, const double *b, double *c, long n);
+  void (*scale)(const double *a, double number, double *c, long n);
+  // c = alpha * x + beta * y; c may be x or y.
+  void (*axpby)(double alpha, const double *x, double beta, const double *y,
+                double *c, long n);
+  int (*unequal)(const double *a, const double *b, long n, double eps);
+  void (*gemm_4x8)(int kc, const double *a, const double *b, double *ab);
+  // b[j][bc + i] = a[i][ac + j] for i, j < 4.
+  void (*transpose_4x4)(double *const *a, int ac, double *const *b, int bc);
+  // y += alpha * x in single precision.
+  void (*axpy_f)(float alpha, const float *x, float *y, long n);
+  void (*gemm_4x16_f)(int kc, const float *a, const float *b, float *ab);
+} simd_kernels_t;
+const simd_kernels_t *simd_kernels(void);
+#ifdef S21_STATS
+void stats_begin(int id);
+void stats_end(int id, double flops);
+void stats_alloc(size_t bytes);
+#define STATS_BEGIN(id) stats_begin(id)
+#define STATS_END(id, flops) stats_end(id, flops)
+#define STATS_ALLOC(bytes) stats_alloc(bytes)
+#else
+#define STATS_BEGIN(id) ((void)0)
+#define STATS_END(id, flops) ((void)0)
+#define STATS_ALLOC(bytes) ((void)0)
+#endif
 void print_m(matrix_t *m);
 void print_v(int *p, int n);
 #endif
\ No newline at end of file
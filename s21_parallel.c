@@ -0,0 +1,89 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "s21_matrix.h"
+
+#define MAX_THREADS 256
+
+typedef struct chunk_struct {
+  parallel_fn fn;
+  void *arg;
+  int begin;
+  int end;
+} chunk_t;
+
+static int num_threads = 0;
+static pthread_once_t num_threads_once = PTHREAD_ONCE_INIT;
+
+static void init_num_threads(void);
+static int clamp_threads(int n);
+static void *run_chunk(void *chunk);
+
+void s21_set_num_threads(int n) {
+  pthread_once(&num_threads_once, init_num_threads);
+  num_threads = clamp_threads(n);
+}
+
+int s21_get_num_threads(void) {
+  pthread_once(&num_threads_once, init_num_threads);
+  return num_threads;
+}
+
+// Splits [0, n) into at most s21_get_num_threads() chunks of at least
+// grain items each. The calling thread runs the first chunk itself, so a
+// single chunk costs no thread at all.
+void parallel_for(int n, int grain, parallel_fn fn, void *arg) {
+  int threads = s21_get_num_threads();
+  if (grain < 1) {
+    grain = 1;
+  }
+  if (threads > n / grain) {
+    threads = n / grain;
+  }
+  if (threads <= 1) {
+    fn(arg, 0, n);
+  } else {
+    pthread_t ids[MAX_THREADS];
+    chunk_t chunks[MAX_THREADS];
+    int started[MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+      chunks[t].fn = fn;
+      chunks[t].arg = arg;
+      chunks[t].begin = (int)((long long)n * t / threads);
+      chunks[t].end = (int)((long long)n * (t + 1) / threads);
+    }
+    for (int t = 1; t < threads; t++) {
+      started[t] = !pthread_create(&ids[t], NULL, run_chunk, &chunks[t]);
+      if (!started[t]) {
+        run_chunk(&chunks[t]);
+      }
+    }
+    run_chunk(&chunks[0]);
+    for (int t = 1; t < threads; t++) {
+      if (started[t]) {
+        pthread_join(ids[t], NULL);
+      }
+    }
+  }
+}
+
+static void init_num_threads(void) {
+  const char *env = getenv("S21_NUM_THREADS");
+  num_threads = clamp_threads(env ? atoi(env) : 1);
+}
+
+static int clamp_threads(int n) {
+  int result = n;
+  if (result < 1) {
+    result = 1;
+  } else if (result > MAX_THREADS) {
+    result = MAX_THREADS;
+  }
+  return result;
+}
+
+static void *run_chunk(void *chunk) {
+  chunk_t *c = chunk;
+  c->fn(c->arg, c->begin, c->end);
+  return NULL;
+}
@@ -0,0 +1,545 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+static int detected_level = S21_SIMD_SCALAR;
+static int active_level = S21_SIMD_SCALAR;
+static simd_kernels_t active_kernels;
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+
+static void init_simd(void);
+static int detect_level(void);
+static void select_kernels(int level);
+
+static void add_scalar(const double *a, const double *b, double *c, long n);
+static void sub_scalar(const double *a, const double *b, double *c, long n);
+static void scale_scalar(const double *a, double number, double *c, long n);
+static void axpby_scalar(double alpha, const double *x, double beta,
+                         const double *y, double *c, long n);
+static int unequal_scalar(const double *a, const double *b, long n,
+                          double eps);
+static void gemm_4x8_scalar(int kc, const double *a, const double *b,
+                            double *ab);
+static void transpose_4x4_scalar(double *const *a, int ac, double *const *b,
+                                 int bc);
+static void axpy_f_scalar(float alpha, const float *x, float *y, long n);
+static void gemm_4x16_f_scalar(int kc, const float *a, const float *b,
+                               float *ab);
+#if SIMD_X86
+static void add_sse2(const double *a, const double *b, double *c, long n);
+static void sub_sse2(const double *a, const double *b, double *c, long n);
+static void scale_sse2(const double *a, double number, double *c, long n);
+static void axpby_sse2(double alpha, const double *x, double beta,
+                       const double *y, double *c, long n);
+static int unequal_sse2(const double *a, const double *b, long n, double eps);
+static void transpose_4x4_sse2(double *const *a, int ac, double *const *b,
+                               int bc);
+static void axpy_f_sse2(float alpha, const float *x, float *y, long n);
+static void add_avx2(const double *a, const double *b, double *c, long n);
+static void sub_avx2(const double *a, const double *b, double *c, long n);
+static void scale_avx2(const double *a, double number, double *c, long n);
+static void axpby_avx2(double alpha, const double *x, double beta,
+                       const double *y, double *c, long n);
+static int unequal_avx2(const double *a, const double *b, long n, double eps);
+static void gemm_4x8_avx2(int kc, const double *a, const double *b,
+                          double *ab);
+static void transpose_4x4_avx2(double *const *a, int ac, double *const *b,
+                               int bc);
+static void axpy_f_avx2(float alpha, const float *x, float *y, long n);
+static void gemm_4x16_f_avx2(int kc, const float *a, const float *b,
+                             float *ab);
+static void add_avx512(const double *a, const double *b, double *c, long n);
+static void sub_avx512(const double *a, const double *b, double *c, long n);
+static void scale_avx512(const double *a, double number, double *c, long n);
+static void axpby_avx512(double alpha, const double *x, double beta,
+                         const double *y, double *c, long n);
+static int unequal_avx512(const double *a, const double *b, long n,
+                          double eps);
+static void axpy_f_avx512(float alpha, const float *x, float *y, long n);
+#endif
+
+int s21_simd_level(void) {
+  pthread_once(&simd_once, init_simd);
+  return active_level;
+}
+
+// Levels above what the CPU supports are clamped, so this can only ever
+// select kernels that are safe to run.
+int s21_set_simd_level(int level) {
+  pthread_once(&simd_once, init_simd);
+  if (level > detected_level) {
+    level = detected_level;
+  }
+  if (level < S21_SIMD_SCALAR) {
+    level = S21_SIMD_SCALAR;
+  }
+  select_kernels(level);
+  return active_level;
+}
+
+const simd_kernels_t *simd_kernels(void) {
+  pthread_once(&simd_once, init_simd);
+  return &active_kernels;
+}
+
+static void init_simd(void) {
+  const char *env = getenv("S21_SIMD");
+  int level = detected_level = detect_level();
+  if (env && !strcmp(env, "scalar")) {
+    level = S21_SIMD_SCALAR;
+  } else if (env && !strcmp(env, "sse2")) {
+    level = S21_SIMD_SSE2;
+  } else if (env && !strcmp(env, "avx2")) {
+    level = S21_SIMD_AVX2;
+  }
+  select_kernels(level < detected_level ? level : detected_level);
+}
+
+static int detect_level(void) {
+  int level = S21_SIMD_SCALAR;
+#if SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    level = S21_SIMD_AVX512;
+  } else if (__builtin_cpu_supports("avx2") &&
+             __builtin_cpu_supports("fma")) {
+    level = S21_SIMD_AVX2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    level = S21_SIMD_SSE2;
+  }
+#endif
+  return level;
+}
+
+static void select_kernels(int level) {
+  simd_kernels_t k = {add_scalar,           sub_scalar,
+                      scale_scalar,         axpby_scalar,
+                      unequal_scalar,       gemm_4x8_scalar,
+                      transpose_4x4_scalar, axpy_f_scalar,
+                      gemm_4x16_f_scalar};
+#if SIMD_X86
+  if (level == S21_SIMD_SSE2) {
+    k = (simd_kernels_t){add_sse2,           sub_sse2,
+                         scale_sse2,         axpby_sse2,
+                         unequal_sse2,       gemm_4x8_scalar,
+                         transpose_4x4_sse2, axpy_f_sse2,
+                         gemm_4x16_f_scalar};
+  } else if (level == S21_SIMD_AVX2) {
+    k = (simd_kernels_t){add_avx2,           sub_avx2,
+                         scale_avx2,         axpby_avx2,
+                         unequal_avx2,       gemm_4x8_avx2,
+                         transpose_4x4_avx2, axpy_f_avx2,
+                         gemm_4x16_f_avx2};
+  } else if (level == S21_SIMD_AVX512) {
+    k = (simd_kernels_t){add_avx512,         sub_avx512,
+                         scale_avx512,       axpby_avx512,
+                         unequal_avx512,     gemm_4x8_avx2,
+                         transpose_4x4_avx2, axpy_f_avx512,
+                         gemm_4x16_f_avx2};
+  }
+#endif
+  active_kernels = k;
+  active_level = level;
+}
+
+static void add_scalar(const double *a, const double *b, double *c, long n) {
+  for (long i = 0; i < n; i++) {
+    c[i] = a[i] + b[i];
+  }
+}
+
+static void sub_scalar(const double *a, const double *b, double *c, long n) {
+  for (long i = 0; i < n; i++) {
+    c[i] = a[i] - b[i];
+  }
+}
+
+static void scale_scalar(const double *a, double number, double *c, long n) {
+  for (long i = 0; i < n; i++) {
+    c[i] = a[i] * number;
+  }
+}
+
+static void axpby_scalar(double alpha, const double *x, double beta,
+                         const double *y, double *c, long n) {
+  for (long i = 0; i < n; i++) {
+    c[i] = alpha * x[i] + beta * y[i];
+  }
+}
+
+// NaN compares as not greater than eps, like the original element loop.
+static int unequal_scalar(const double *a, const double *b, long n,
+                          double eps) {
+  int unequal = 0;
+  for (long i = 0; i < n; i++) {
+    unequal |= fabs(a[i] - b[i]) > eps;
+  }
+  return unequal;
+}
+
+static void gemm_4x8_scalar(int kc, const double *a, const double *b,
+                            double *ab) {
+  double acc[4][8] = {{0}};
+  for (int p = 0; p < kc; p++) {
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 8; j++) {
+        acc[i][j] += a[i] * b[j];
+      }
+    }
+    a += 4;
+    b += 8;
+  }
+  memcpy(ab, acc, sizeof(acc));
+}
+
+static void transpose_4x4_scalar(double *const *a, int ac, double *const *b,
+                                 int bc) {
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      b[j][bc + i] = a[i][ac + j];
+    }
+  }
+}
+
+static void axpy_f_scalar(float alpha, const float *x, float *y, long n) {
+  for (long i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+static void gemm_4x16_f_scalar(int kc, const float *a, const float *b,
+                               float *ab) {
+  float acc[4][16] = {{0}};
+  for (int p = 0; p < kc; p++) {
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 16; j++) {
+        acc[i][j] += a[i] * b[j];
+      }
+    }
+    a += 4;
+    b += 16;
+  }
+  memcpy(ab, acc, sizeof(acc));
+}
+
+#if SIMD_X86
+static void add_sse2(const double *a, const double *b, double *c, long n) {
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(c + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  add_scalar(a + i, b + i, c + i, n - i);
+}
+
+static void sub_sse2(const double *a, const double *b, double *c, long n) {
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(c + i, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  sub_scalar(a + i, b + i, c + i, n - i);
+}
+
+static void scale_sse2(const double *a, double number, double *c, long n) {
+  __m128d k = _mm_set1_pd(number);
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(c + i, _mm_mul_pd(_mm_loadu_pd(a + i), k));
+  }
+  scale_scalar(a + i, number, c + i, n - i);
+}
+
+static void axpby_sse2(double alpha, const double *x, double beta,
+                       const double *y, double *c, long n) {
+  __m128d ka = _mm_set1_pd(alpha), kb = _mm_set1_pd(beta);
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d ax = _mm_mul_pd(_mm_loadu_pd(x + i), ka);
+    _mm_storeu_pd(c + i, _mm_add_pd(ax, _mm_mul_pd(_mm_loadu_pd(y + i), kb)));
+  }
+  axpby_scalar(alpha, x + i, beta, y + i, c + i, n - i);
+}
+
+static int unequal_sse2(const double *a, const double *b, long n,
+                        double eps) {
+  __m128d e = _mm_set1_pd(eps), sign = _mm_set1_pd(-0.0);
+  __m128d any = _mm_setzero_pd();
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d d = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+    any = _mm_or_pd(any, _mm_cmpgt_pd(_mm_andnot_pd(sign, d), e));
+  }
+  return _mm_movemask_pd(any) || unequal_scalar(a + i, b + i, n - i, eps);
+}
+
+// Four 2 x 2 blocks, each transposed by one unpacklo / unpackhi pair.
+static void transpose_4x4_sse2(double *const *a, int ac, double *const *b,
+                               int bc) {
+  for (int i = 0; i < 4; i += 2) {
+    for (int j = 0; j < 4; j += 2) {
+      __m128d r0 = _mm_loadu_pd(a[i] + ac + j);
+      __m128d r1 = _mm_loadu_pd(a[i + 1] + ac + j);
+      _mm_storeu_pd(b[j] + bc + i, _mm_unpacklo_pd(r0, r1));
+      _mm_storeu_pd(b[j + 1] + bc + i, _mm_unpackhi_pd(r0, r1));
+    }
+  }
+}
+
+static void axpy_f_sse2(float alpha, const float *x, float *y, long n) {
+  __m128 k = _mm_set1_ps(alpha);
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 d = _mm_mul_ps(_mm_loadu_ps(x + i), k);
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), d));
+  }
+  axpy_f_scalar(alpha, x + i, y + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void add_avx2(const double *a,
+                                                      const double *b,
+                                                      double *c, long n) {
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(c + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                          _mm256_loadu_pd(b + i)));
+  }
+  add_scalar(a + i, b + i, c + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void sub_avx2(const double *a,
+                                                      const double *b,
+                                                      double *c, long n) {
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(c + i, _mm256_sub_pd(_mm256_loadu_pd(a + i),
+                                          _mm256_loadu_pd(b + i)));
+  }
+  sub_scalar(a + i, b + i, c + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void scale_avx2(const double *a,
+                                                        double number,
+                                                        double *c, long n) {
+  __m256d k = _mm256_set1_pd(number);
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(c + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), k));
+  }
+  scale_scalar(a + i, number, c + i, n - i);
+}
+
+// Multiply and add stay separate, so each element rounds as in the scalar
+// kernel.
+__attribute__((target("avx2"))) static void axpby_avx2(
+    double alpha, const double *x, double beta, const double *y, double *c,
+    long n) {
+  __m256d ka = _mm256_set1_pd(alpha), kb = _mm256_set1_pd(beta);
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d ax = _mm256_mul_pd(_mm256_loadu_pd(x + i), ka);
+    __m256d by = _mm256_mul_pd(_mm256_loadu_pd(y + i), kb);
+    _mm256_storeu_pd(c + i, _mm256_add_pd(ax, by));
+  }
+  axpby_scalar(alpha, x + i, beta, y + i, c + i, n - i);
+}
+
+__attribute__((target("avx2"))) static int unequal_avx2(const double *a,
+                                                         const double *b,
+                                                         long n, double eps) {
+  __m256d e = _mm256_set1_pd(eps), sign = _mm256_set1_pd(-0.0);
+  __m256d any = _mm256_setzero_pd();
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d d = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+    any = _mm256_or_pd(
+        any, _mm256_cmp_pd(_mm256_andnot_pd(sign, d), e, _CMP_GT_OQ));
+  }
+  return _mm256_movemask_pd(any) || unequal_scalar(a + i, b + i, n - i, eps);
+}
+
+// Eight 256-bit accumulators hold the whole 4 x 8 tile, enough independent
+// FMA chains to cover the FMA latency on two ports.
+__attribute__((target("avx2,fma"))) static void gemm_4x8_avx2(
+    int kc, const double *a, const double *b, double *ab) {
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  for (int p = 0; p < kc; p++) {
+    __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+    __m256d a0 = _mm256_broadcast_sd(a), a1 = _mm256_broadcast_sd(a + 1);
+    c00 = _mm256_fmadd_pd(a0, b0, c00);
+    c01 = _mm256_fmadd_pd(a0, b1, c01);
+    c10 = _mm256_fmadd_pd(a1, b0, c10);
+    c11 = _mm256_fmadd_pd(a1, b1, c11);
+    a0 = _mm256_broadcast_sd(a + 2);
+    a1 = _mm256_broadcast_sd(a + 3);
+    c20 = _mm256_fmadd_pd(a0, b0, c20);
+    c21 = _mm256_fmadd_pd(a0, b1, c21);
+    c30 = _mm256_fmadd_pd(a1, b0, c30);
+    c31 = _mm256_fmadd_pd(a1, b1, c31);
+    a += 4;
+    b += 8;
+  }
+  _mm256_storeu_pd(ab, c00);
+  _mm256_storeu_pd(ab + 4, c01);
+  _mm256_storeu_pd(ab + 8, c10);
+  _mm256_storeu_pd(ab + 12, c11);
+  _mm256_storeu_pd(ab + 16, c20);
+  _mm256_storeu_pd(ab + 20, c21);
+  _mm256_storeu_pd(ab + 24, c30);
+  _mm256_storeu_pd(ab + 28, c31);
+}
+
+// Unpacks interleave pairs of rows within each 128-bit lane, then the lane
+// permutes assemble the columns.
+__attribute__((target("avx2"))) static void transpose_4x4_avx2(
+    double *const *a, int ac, double *const *b, int bc) {
+  __m256d r0 = _mm256_loadu_pd(a[0] + ac), r1 = _mm256_loadu_pd(a[1] + ac);
+  __m256d r2 = _mm256_loadu_pd(a[2] + ac), r3 = _mm256_loadu_pd(a[3] + ac);
+  __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+  __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+  _mm256_storeu_pd(b[0] + bc, _mm256_permute2f128_pd(t0, t2, 0x20));
+  _mm256_storeu_pd(b[1] + bc, _mm256_permute2f128_pd(t1, t3, 0x20));
+  _mm256_storeu_pd(b[2] + bc, _mm256_permute2f128_pd(t0, t2, 0x31));
+  _mm256_storeu_pd(b[3] + bc, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+// Two independent FMA chains per iteration, sixteen floats.
+__attribute__((target("avx2,fma"))) static void axpy_f_avx2(float alpha,
+                                                            const float *x,
+                                                            float *y, long n) {
+  __m256 k = _mm256_set1_ps(alpha);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256 y0 = _mm256_fmadd_ps(k, _mm256_loadu_ps(x + i),
+                                _mm256_loadu_ps(y + i));
+    __m256 y1 = _mm256_fmadd_ps(k, _mm256_loadu_ps(x + i + 8),
+                                _mm256_loadu_ps(y + i + 8));
+    _mm256_storeu_ps(y + i, y0);
+    _mm256_storeu_ps(y + i + 8, y1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(k, _mm256_loadu_ps(x + i),
+                                            _mm256_loadu_ps(y + i)));
+  }
+  axpy_f_scalar(alpha, x + i, y + i, n - i);
+}
+
+// gemm_4x8_avx2's register tile with floats: the same eight accumulators
+// hold twice the elements.
+__attribute__((target("avx2,fma"))) static void gemm_4x16_f_avx2(
+    int kc, const float *a, const float *b, float *ab) {
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  for (int p = 0; p < kc; p++) {
+    __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+    __m256 a0 = _mm256_broadcast_ss(a), a1 = _mm256_broadcast_ss(a + 1);
+    c00 = _mm256_fmadd_ps(a0, b0, c00);
+    c01 = _mm256_fmadd_ps(a0, b1, c01);
+    c10 = _mm256_fmadd_ps(a1, b0, c10);
+    c11 = _mm256_fmadd_ps(a1, b1, c11);
+    a0 = _mm256_broadcast_ss(a + 2);
+    a1 = _mm256_broadcast_ss(a + 3);
+    c20 = _mm256_fmadd_ps(a0, b0, c20);
+    c21 = _mm256_fmadd_ps(a0, b1, c21);
+    c30 = _mm256_fmadd_ps(a1, b0, c30);
+    c31 = _mm256_fmadd_ps(a1, b1, c31);
+    a += 4;
+    b += 16;
+  }
+  _mm256_storeu_ps(ab, c00);
+  _mm256_storeu_ps(ab + 8, c01);
+  _mm256_storeu_ps(ab + 16, c10);
+  _mm256_storeu_ps(ab + 24, c11);
+  _mm256_storeu_ps(ab + 32, c20);
+  _mm256_storeu_ps(ab + 40, c21);
+  _mm256_storeu_ps(ab + 48, c30);
+  _mm256_storeu_ps(ab + 56, c31);
+}
+
+__attribute__((target("avx512f"))) static void add_avx512(const double *a,
+                                                           const double *b,
+                                                           double *c,
+                                                           long n) {
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(c + i, _mm512_add_pd(_mm512_loadu_pd(a + i),
+                                          _mm512_loadu_pd(b + i)));
+  }
+  add_scalar(a + i, b + i, c + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static void sub_avx512(const double *a,
+                                                           const double *b,
+                                                           double *c,
+                                                           long n) {
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(c + i, _mm512_sub_pd(_mm512_loadu_pd(a + i),
+                                          _mm512_loadu_pd(b + i)));
+  }
+  sub_scalar(a + i, b + i, c + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static void scale_avx512(const double *a,
+                                                             double number,
+                                                             double *c,
+                                                             long n) {
+  __m512d k = _mm512_set1_pd(number);
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(c + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), k));
+  }
+  scale_scalar(a + i, number, c + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static void axpby_avx512(
+    double alpha, const double *x, double beta, const double *y, double *c,
+    long n) {
+  __m512d ka = _mm512_set1_pd(alpha), kb = _mm512_set1_pd(beta);
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d ax = _mm512_mul_pd(_mm512_loadu_pd(x + i), ka);
+    __m512d by = _mm512_mul_pd(_mm512_loadu_pd(y + i), kb);
+    _mm512_storeu_pd(c + i, _mm512_add_pd(ax, by));
+  }
+  axpby_scalar(alpha, x + i, beta, y + i, c + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static int unequal_avx512(
+    const double *a, const double *b, long n, double eps) {
+  __m512d e = _mm512_set1_pd(eps);
+  __mmask8 any = 0;
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d d = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+    any |= _mm512_cmp_pd_mask(_mm512_abs_pd(d), e, _CMP_GT_OQ);
+  }
+  return any || unequal_scalar(a + i, b + i, n - i, eps);
+}
+
+__attribute__((target("avx512f"))) static void axpy_f_avx512(float alpha,
+                                                              const float *x,
+                                                              float *y,
+                                                              long n) {
+  __m512 k = _mm512_set1_ps(alpha);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(y + i, _mm512_fmadd_ps(k, _mm512_loadu_ps(x + i),
+                                            _mm512_loadu_ps(y + i)));
+  }
+  axpy_f_scalar(alpha, x + i, y + i, n - i);
+}
+#endif
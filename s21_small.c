@@ -0,0 +1,553 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+// Matrices of up to SMALL_ORDER rows go through closed forms evaluated on
+// BATCH_LANES of them at once. A tile holds element e of lane l at
+// tile[e * BATCH_LANES + l], so every formula is one loop over l that the
+// compiler turns into vector code. A single row-major matrix is the same
+// layout with one lane.
+#define BATCH_LANES 8
+// Elements per matrix a tile can hold; bigger products go one by one.
+#define BATCH_TILE 64
+// Elements per parallel task.
+#define BATCH_GRAIN (1 << 15)
+
+enum batch_op { BATCH_DET, BATCH_INVERSE, BATCH_MULT };
+
+typedef struct batch_args_struct {
+  int op;
+  int tiled;
+  s21_batch_t *A;
+  s21_batch_t *B;
+  s21_batch_t *result;
+  double *det;
+  atomic_int singular;
+  atomic_int error;
+} batch_args_t;
+
+static int check_bad_batch(s21_batch_t *A);
+static int run_batch(batch_args_t *args);
+static void batch_blocks(void *arg, int begin, int end);
+static void batch_tiles(batch_args_t *args, int begin, int end);
+static void batch_det_inverse(batch_args_t *args, int first, int last);
+static int create_scratch(int n, matrix_t *M);
+static void remove_scratch(matrix_t *M);
+static void batch_mult(batch_args_t *args, int first, int last);
+static void load_tile(s21_batch_t *A, int first, int lanes, double *tile);
+static void store_tile(double *tile, int first, int lanes, s21_batch_t *A);
+static void det_lanes(int n, const double *a, double *det, int lanes);
+static void adjugate_lanes(int n, const double *a, double *adj, double *det,
+                           int lanes);
+static void adjugate4_lanes(const double *a, double *adj, double *det,
+                            int lanes);
+static void mult_lanes(int m, int k, int n, const double *a, const double *b,
+                       double *c, int lanes);
+
+int s21_mat2_determinant(const s21_mat2_t *A, double *result) {
+  int error = !A || !result;
+  if (!error) {
+    *result = small_determinant(2, &A->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat2_inverse(const s21_mat2_t *A, s21_mat2_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    error = small_inverse(2, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat2_complements(const s21_mat2_t *A, s21_mat2_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    small_complements(2, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat3_determinant(const s21_mat3_t *A, double *result) {
+  int error = !A || !result;
+  if (!error) {
+    *result = small_determinant(3, &A->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat3_inverse(const s21_mat3_t *A, s21_mat3_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    error = small_inverse(3, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat3_complements(const s21_mat3_t *A, s21_mat3_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    small_complements(3, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat4_determinant(const s21_mat4_t *A, double *result) {
+  int error = !A || !result;
+  if (!error) {
+    *result = small_determinant(4, &A->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat4_inverse(const s21_mat4_t *A, s21_mat4_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    error = small_inverse(4, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+int s21_mat4_complements(const s21_mat4_t *A, s21_mat4_t *result) {
+  int error = !A || !result;
+  if (!error) {
+    small_complements(4, &A->m[0][0], &result->m[0][0]);
+  }
+  return error;
+}
+
+// Closed forms for a row-major n x n array a, n <= SMALL_ORDER.
+double small_determinant(int n, const double *a) {
+  double det = 0;
+  det_lanes(n, a, &det, 1);
+  return det;
+}
+
+// Returns 2 and leaves result alone when a is singular. result may be a.
+int small_inverse(int n, const double *a, double *result) {
+  double adj[SMALL_ORDER * SMALL_ORDER], det = 0;
+  adjugate_lanes(n, a, adj, &det, 1);
+  int error = det == 0 ? 2 : 0;
+  for (int e = 0; e < n * n && !error; e++) {
+    result[e] = adj[e] / det;
+  }
+  return error;
+}
+
+// Cofactor (i, j) is adjugate element (j, i). result may be a.
+void small_complements(int n, const double *a, double *result) {
+  double adj[SMALL_ORDER * SMALL_ORDER], det = 0;
+  adjugate_lanes(n, a, adj, &det, 1);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      result[i * n + j] = adj[j * n + i];
+    }
+  }
+}
+
+int s21_batch_create(int count, int rows, int columns, s21_batch_t *result) {
+  int error = !result || count <= 0 || rows <= 0 || columns <= 0;
+  if (!error) {
+    size_t size = (size_t)count * rows * columns * sizeof(double);
+    result->allocator = *s21_get_allocator();
+    result->data = result->allocator.alloc(result->allocator.ctx, size,
+                                           S21_ALIGNMENT);
+    error = result->data ? 0 : 1;
+    if (!error) {
+      memset(result->data, 0, size);
+      result->count = count;
+      result->rows = rows;
+      result->columns = columns;
+      result->stride = (long)rows * columns;
+    }
+  }
+  return error;
+}
+
+void s21_batch_remove(s21_batch_t *A) {
+  if (A && A->data) {
+    A->allocator.free(A->allocator.ctx, A->data);
+    A->data = NULL;
+    A->count = 0;
+    A->rows = 0;
+    A->columns = 0;
+    A->stride = 0;
+  }
+}
+
+int s21_batch_determinant(s21_batch_t *A, double *result) {
+  int error = check_bad_batch(A) || !result;
+  if (!error && A->rows != A->columns) {
+    error = 2;
+  }
+  if (!error) {
+    batch_args_t args = {BATCH_DET, A->rows <= SMALL_ORDER, A, NULL, NULL,
+                         result, 0, 0};
+    error = run_batch(&args);
+  }
+  return error;
+}
+
+int s21_batch_inverse(s21_batch_t *A, s21_batch_t *result) {
+  int error = check_bad_batch(A) || check_bad_batch(result);
+  if (!error && (A->rows != A->columns || result->count != A->count ||
+                 result->rows != A->rows || result->columns != A->columns)) {
+    error = 2;
+  }
+  if (!error) {
+    batch_args_t args = {BATCH_INVERSE, A->rows <= SMALL_ORDER, A, NULL,
+                         result, NULL, 0, 0};
+    error = run_batch(&args);
+  }
+  return error;
+}
+
+int s21_batch_mult(s21_batch_t *A, s21_batch_t *B, s21_batch_t *result) {
+  int error = check_bad_batch(A) || check_bad_batch(B) ||
+              check_bad_batch(result);
+  if (!error &&
+      (A->columns != B->rows || B->count != A->count ||
+       result->count != A->count || result->rows != A->rows ||
+       result->columns != B->columns)) {
+    error = 2;
+  }
+  if (!error) {
+    int largest = A->rows * A->columns;
+    if (B->rows * B->columns > largest) {
+      largest = B->rows * B->columns;
+    }
+    if (result->rows * result->columns > largest) {
+      largest = result->rows * result->columns;
+    }
+    batch_args_t args = {BATCH_MULT, largest <= BATCH_TILE, A, B, result,
+                         NULL, 0, 0};
+    error = run_batch(&args);
+  }
+  return error;
+}
+
+static int check_bad_batch(s21_batch_t *A) {
+  int error = 0;
+  if (!A || !(A->data) || A->count <= 0 || A->rows <= 0 || A->columns <= 0 ||
+      A->stride < (long)A->rows * A->columns) {
+    error = 1;
+  }
+  return error;
+}
+
+// Tasks hand out whole blocks of BATCH_LANES matrices.
+static int run_batch(batch_args_t *args) {
+  s21_batch_t *A = args->A;
+  long work = (long)A->rows * (A->rows + A->columns) * BATCH_LANES;
+  int blocks = (A->count + BATCH_LANES - 1) / BATCH_LANES;
+  int grain = work >= BATCH_GRAIN ? 1 : (int)(BATCH_GRAIN / work);
+  parallel_for(blocks, grain, batch_blocks, args);
+  int error = atomic_load(&args->error);
+  if (!error && atomic_load(&args->singular)) {
+    error = 2;
+  }
+  return error;
+}
+
+static void batch_blocks(void *arg, int begin, int end) {
+  batch_args_t *args = arg;
+  int first = begin * BATCH_LANES;
+  int last = end * BATCH_LANES < args->A->count ? end * BATCH_LANES
+                                                : args->A->count;
+  if (args->tiled) {
+    batch_tiles(args, begin, end);
+  } else if (args->op == BATCH_MULT) {
+    batch_mult(args, first, last);
+  } else {
+    batch_det_inverse(args, first, last);
+  }
+}
+
+static void batch_tiles(batch_args_t *args, int begin, int end) {
+  double a[BATCH_TILE * BATCH_LANES], b[BATCH_TILE * BATCH_LANES];
+  double c[BATCH_TILE * BATCH_LANES], det[BATCH_LANES];
+  s21_batch_t *A = args->A;
+  int n = A->rows;
+  for (int block = begin; block < end; block++) {
+    int first = block * BATCH_LANES;
+    int lanes = A->count - first < BATCH_LANES ? A->count - first
+                                               : BATCH_LANES;
+    load_tile(A, first, lanes, a);
+    if (args->op == BATCH_DET) {
+      det_lanes(n, a, det, BATCH_LANES);
+      memcpy(args->det + first, det, lanes * sizeof(double));
+    } else if (args->op == BATCH_INVERSE) {
+      adjugate_lanes(n, a, c, det, BATCH_LANES);
+      for (int l = 0; l < lanes; l++) {
+        if (det[l] == 0) {
+          atomic_store(&args->singular, 1);
+        }
+      }
+      for (int l = 0; l < BATCH_LANES; l++) {
+        det[l] = det[l] == 0 ? 0 : 1 / det[l];
+      }
+      for (int e = 0; e < n * n; e++) {
+        for (int l = 0; l < BATCH_LANES; l++) {
+          c[e * BATCH_LANES + l] *= det[l];
+        }
+      }
+      store_tile(c, first, lanes, args->result);
+    } else {
+      load_tile(args->B, first, lanes, b);
+      mult_lanes(A->rows, A->columns, args->B->columns, a, b, c,
+                 BATCH_LANES);
+      store_tile(c, first, lanes, args->result);
+    }
+  }
+}
+
+static void batch_det_inverse(batch_args_t *args, int first, int last) {
+  int n = args->A->rows, inverse = args->op == BATCH_INVERSE;
+  matrix_t M = {0}, I = {0};
+  int *p = malloc(n * sizeof(int));
+  int error = p ? 0 : 1;
+  if (!error) {
+    error = create_scratch(n, &M);
+  }
+  if (!error && inverse) {
+    error = create_scratch(n, &I);
+  }
+  for (int b = first; b < last && !error; b++) {
+    double det = 0, *a = args->A->data + b * args->A->stride;
+    // The factorization swaps row pointers, so rows go in one at a time.
+    for (int i = 0; i < n; i++) {
+      memcpy(M.matrix[i], a + i * n, n * sizeof(double));
+    }
+    int singular = lu_scratch(&M, p, &det, inverse ? &I : NULL);
+    if (!inverse) {
+      args->det[b] = det;
+    } else {
+      double *r = args->result->data + b * args->result->stride;
+      if (singular) {
+        atomic_store(&args->singular, 1);
+        memset(r, 0, (size_t)n * n * sizeof(double));
+      } else {
+        for (int i = 0; i < n; i++) {
+          memcpy(r + i * n, I.matrix[i], n * sizeof(double));
+        }
+      }
+    }
+  }
+  if (error) {
+    atomic_store(&args->error, 1);
+  }
+  remove_scratch(&I);
+  remove_scratch(&M);
+  free(p);
+}
+
+// Workers run concurrently, and the installed allocator (an arena, say)
+// need not be thread-safe, so per-worker scratch comes from malloc.
+static int create_scratch(int n, matrix_t *M) {
+  M->rows = n;
+  M->columns = n;
+  M->ld = n;
+  M->matrix = malloc(n * sizeof(double *));
+  M->data = malloc((size_t)n * n * sizeof(double));
+  int error = M->matrix && M->data ? 0 : 1;
+  for (int i = 0; i < n && !error; i++) {
+    M->matrix[i] = M->data + i * n;
+  }
+  return error;
+}
+
+// The factorization permutes the row pointers, so the block is freed
+// through data rather than matrix[0].
+static void remove_scratch(matrix_t *M) {
+  free(M->data);
+  free(M->matrix);
+  M->data = NULL;
+  M->matrix = NULL;
+}
+
+// Products too big for a tile: i-k-j per matrix into scratch, which also
+// keeps a result that shares an operand's buffer correct.
+static void batch_mult(batch_args_t *args, int first, int last) {
+  s21_batch_t *A = args->A, *B = args->B, *R = args->result;
+  int m = A->rows, k = A->columns, n = B->columns;
+  double *c = malloc((size_t)m * n * sizeof(double));
+  if (!c) {
+    atomic_store(&args->error, 1);
+  }
+  for (int b = first; b < last && c; b++) {
+    const double *a = A->data + b * A->stride, *bb = B->data + b * B->stride;
+    memset(c, 0, (size_t)m * n * sizeof(double));
+    for (int i = 0; i < m; i++) {
+      for (int p = 0; p < k; p++) {
+        double aip = a[i * k + p];
+        for (int j = 0; j < n; j++) {
+          c[i * n + j] += aip * bb[p * n + j];
+        }
+      }
+    }
+    memcpy(R->data + b * R->stride, c, (size_t)m * n * sizeof(double));
+  }
+  free(c);
+}
+
+// Unused lanes repeat the first matrix so they stay finite.
+static void load_tile(s21_batch_t *A, int first, int lanes, double *tile) {
+  int size = A->rows * A->columns;
+  for (int l = 0; l < BATCH_LANES; l++) {
+    const double *a = A->data + (first + (l < lanes ? l : 0)) * A->stride;
+    for (int e = 0; e < size; e++) {
+      tile[e * BATCH_LANES + l] = a[e];
+    }
+  }
+}
+
+static void store_tile(double *tile, int first, int lanes, s21_batch_t *A) {
+  int size = A->rows * A->columns;
+  for (int l = 0; l < lanes; l++) {
+    double *a = A->data + (first + l) * A->stride;
+    for (int e = 0; e < size; e++) {
+      a[e] = tile[e * BATCH_LANES + l];
+    }
+  }
+}
+
+// Element (i, j) of lane l in an n x n tile.
+#define A(i, j) a[((i) * n + (j)) * lanes + l]
+#define ADJ(i, j) adj[((i) * n + (j)) * lanes + l]
+
+static void det_lanes(int n, const double *a, double *det, int lanes) {
+  if (n == 1) {
+    for (int l = 0; l < lanes; l++) {
+      det[l] = A(0, 0);
+    }
+  } else if (n == 2) {
+    for (int l = 0; l < lanes; l++) {
+      det[l] = A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+    }
+  } else if (n == 3) {
+    for (int l = 0; l < lanes; l++) {
+      det[l] = A(0, 0) * (A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1)) -
+               A(0, 1) * (A(1, 0) * A(2, 2) - A(1, 2) * A(2, 0)) +
+               A(0, 2) * (A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0));
+    }
+  } else {
+    // Laplace expansion over 2x2 minors of the top and bottom row pairs.
+    for (int l = 0; l < lanes; l++) {
+      double s0 = A(0, 0) * A(1, 1) - A(1, 0) * A(0, 1);
+      double s1 = A(0, 0) * A(1, 2) - A(1, 0) * A(0, 2);
+      double s2 = A(0, 0) * A(1, 3) - A(1, 0) * A(0, 3);
+      double s3 = A(0, 1) * A(1, 2) - A(1, 1) * A(0, 2);
+      double s4 = A(0, 1) * A(1, 3) - A(1, 1) * A(0, 3);
+      double s5 = A(0, 2) * A(1, 3) - A(1, 2) * A(0, 3);
+      double c5 = A(2, 2) * A(3, 3) - A(3, 2) * A(2, 3);
+      double c4 = A(2, 1) * A(3, 3) - A(3, 1) * A(2, 3);
+      double c3 = A(2, 1) * A(3, 2) - A(3, 1) * A(2, 2);
+      double c2 = A(2, 0) * A(3, 3) - A(3, 0) * A(2, 3);
+      double c1 = A(2, 0) * A(3, 2) - A(3, 0) * A(2, 2);
+      double c0 = A(2, 0) * A(3, 1) - A(3, 0) * A(2, 1);
+      det[l] = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+  }
+}
+
+// adj = det(A) * A^-1, the transposed matrix of cofactors.
+static void adjugate_lanes(int n, const double *a, double *adj, double *det,
+                           int lanes) {
+  if (n == 1) {
+    for (int l = 0; l < lanes; l++) {
+      ADJ(0, 0) = 1;
+      det[l] = A(0, 0);
+    }
+  } else if (n == 2) {
+    for (int l = 0; l < lanes; l++) {
+      det[l] = A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+      ADJ(0, 0) = A(1, 1);
+      ADJ(0, 1) = -A(0, 1);
+      ADJ(1, 0) = -A(1, 0);
+      ADJ(1, 1) = A(0, 0);
+    }
+  } else if (n == 3) {
+    for (int l = 0; l < lanes; l++) {
+      double b00 = A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1);
+      double b01 = A(0, 2) * A(2, 1) - A(0, 1) * A(2, 2);
+      double b02 = A(0, 1) * A(1, 2) - A(0, 2) * A(1, 1);
+      double b10 = A(1, 2) * A(2, 0) - A(1, 0) * A(2, 2);
+      double b11 = A(0, 0) * A(2, 2) - A(0, 2) * A(2, 0);
+      double b12 = A(0, 2) * A(1, 0) - A(0, 0) * A(1, 2);
+      double b20 = A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0);
+      double b21 = A(0, 1) * A(2, 0) - A(0, 0) * A(2, 1);
+      double b22 = A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+      det[l] = A(0, 0) * b00 + A(0, 1) * b10 + A(0, 2) * b20;
+      ADJ(0, 0) = b00;
+      ADJ(0, 1) = b01;
+      ADJ(0, 2) = b02;
+      ADJ(1, 0) = b10;
+      ADJ(1, 1) = b11;
+      ADJ(1, 2) = b12;
+      ADJ(2, 0) = b20;
+      ADJ(2, 1) = b21;
+      ADJ(2, 2) = b22;
+    }
+  } else {
+    adjugate4_lanes(a, adj, det, lanes);
+  }
+}
+
+static void adjugate4_lanes(const double *a, double *adj, double *det,
+                            int lanes) {
+  const int n = 4;
+  for (int l = 0; l < lanes; l++) {
+    double a00 = A(0, 0), a01 = A(0, 1), a02 = A(0, 2), a03 = A(0, 3);
+    double a10 = A(1, 0), a11 = A(1, 1), a12 = A(1, 2), a13 = A(1, 3);
+    double a20 = A(2, 0), a21 = A(2, 1), a22 = A(2, 2), a23 = A(2, 3);
+    double a30 = A(3, 0), a31 = A(3, 1), a32 = A(3, 2), a33 = A(3, 3);
+    double s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02;
+    double s2 = a00 * a13 - a10 * a03, s3 = a01 * a12 - a11 * a02;
+    double s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+    double c5 = a22 * a33 - a32 * a23, c4 = a21 * a33 - a31 * a23;
+    double c3 = a21 * a32 - a31 * a22, c2 = a20 * a33 - a30 * a23;
+    double c1 = a20 * a32 - a30 * a22, c0 = a20 * a31 - a30 * a21;
+    det[l] = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    ADJ(0, 0) = a11 * c5 - a12 * c4 + a13 * c3;
+    ADJ(0, 1) = -a01 * c5 + a02 * c4 - a03 * c3;
+    ADJ(0, 2) = a31 * s5 - a32 * s4 + a33 * s3;
+    ADJ(0, 3) = -a21 * s5 + a22 * s4 - a23 * s3;
+    ADJ(1, 0) = -a10 * c5 + a12 * c2 - a13 * c1;
+    ADJ(1, 1) = a00 * c5 - a02 * c2 + a03 * c1;
+    ADJ(1, 2) = -a30 * s5 + a32 * s2 - a33 * s1;
+    ADJ(1, 3) = a20 * s5 - a22 * s2 + a23 * s1;
+    ADJ(2, 0) = a10 * c4 - a11 * c2 + a13 * c0;
+    ADJ(2, 1) = -a00 * c4 + a01 * c2 - a03 * c0;
+    ADJ(2, 2) = a30 * s4 - a31 * s2 + a33 * s0;
+    ADJ(2, 3) = -a20 * s4 + a21 * s2 - a23 * s0;
+    ADJ(3, 0) = -a10 * c3 + a11 * c1 - a12 * c0;
+    ADJ(3, 1) = a00 * c3 - a01 * c1 + a02 * c0;
+    ADJ(3, 2) = -a30 * s3 + a31 * s1 - a32 * s0;
+    ADJ(3, 3) = a20 * s3 - a21 * s1 + a22 * s0;
+  }
+}
+
+#undef A
+#undef ADJ
+
+// c = a * b for m x k by k x n tiles.
+static void mult_lanes(int m, int k, int n, const double *a, const double *b,
+                       double *c, int lanes) {
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      double *cij = c + (i * n + j) * lanes;
+      for (int l = 0; l < lanes; l++) {
+        cij[l] = 0;
+      }
+      for (int p = 0; p < k; p++) {
+        const double *aip = a + (i * k + p) * lanes;
+        const double *bpj = b + (p * n + j) * lanes;
+        for (int l = 0; l < lanes; l++) {
+          cij[l] += aip[l] * bpj[l];
+        }
+      }
+    }
+  }
+}
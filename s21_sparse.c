@@ -0,0 +1,804 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+// A diagonal candidate pivot is kept while it is at least this fraction of
+// the column's largest candidate, so the ordering's fill pattern survives
+// pivoting on well-behaved matrices.
+#define SPARSE_PIVOT_TOLERANCE 0.1
+// Smallest number of multiply-adds handed to one thread.
+#define SPARSE_GRAIN (1 << 14)
+
+typedef struct spmm_struct {
+  s21_sparse_t *A;
+  matrix_t *B;
+  matrix_t *result;
+} spmm_t;
+
+static int check_bad_sparse(s21_sparse_t *A);
+static int check_bad_sparse_lu(s21_sparse_lu_t *lu);
+static int sparse_reserve(s21_sparse_t *A, int capacity);
+static int sparse_combine(s21_sparse_t *A, s21_sparse_t *B, double sign,
+                          s21_sparse_t *result);
+static void merge_duplicates(s21_sparse_t *A);
+static void mult_rows(void *arg, int begin, int end);
+static int compare_ints(const void *a, const void *b);
+static int compare_keys(const void *a, const void *b);
+static int rcm_order(s21_sparse_t *A, s21_sparse_t *At, int *order);
+static int visit_neighbours(s21_sparse_t *A, int v, int *order, int tail,
+                            char *visited);
+static int factor_columns(s21_sparse_t *At, s21_sparse_lu_t *lu,
+                          double *flops);
+static int sparse_reach(s21_sparse_t *L, s21_sparse_t *At, int column,
+                        int *xi, int *pstack, char *mark, const int *pinv);
+static int depth_first(s21_sparse_t *L, int j, int top, int *xi, int *pstack,
+                       char *mark, const int *pinv);
+static int permutation_sign(const int *p, int n);
+
+int s21_sparse_create(int rows, int columns, int capacity,
+                      s21_sparse_t *result) {
+  int error = !result || rows <= 0 || columns <= 0 || capacity < 0;
+  if (!error) {
+    s21_allocator_t *a = &result->allocator;
+    *a = *s21_get_allocator();
+    result->values = NULL;
+    result->column_index = NULL;
+    result->row_start =
+        a->alloc(a->ctx, (rows + 1) * sizeof(int), _Alignof(int));
+    result->rows = rows;
+    result->columns = columns;
+    result->nnz = 0;
+    result->capacity = 0;
+    error = !result->row_start || sparse_reserve(result, capacity);
+    if (!error) {
+      STATS_ALLOC((rows + 1) * sizeof(int));
+      memset(result->row_start, 0, (rows + 1) * sizeof(int));
+    } else {
+      s21_sparse_remove(result);
+    }
+  }
+  return error;
+}
+
+void s21_sparse_remove(s21_sparse_t *A) {
+  if (A) {
+    s21_allocator_t *a = &A->allocator;
+    if (A->values) {
+      a->free(a->ctx, A->values);
+    }
+    if (A->column_index) {
+      a->free(a->ctx, A->column_index);
+    }
+    if (A->row_start) {
+      a->free(a->ctx, A->row_start);
+    }
+    A->values = NULL;
+    A->column_index = NULL;
+    A->row_start = NULL;
+    A->rows = 0;
+    A->columns = 0;
+    A->nnz = 0;
+    A->capacity = 0;
+  }
+}
+
+// Exact zeros of A are dropped.
+int s21_sparse_from_dense(matrix_t *A, s21_sparse_t *result) {
+  int error = check_bad_matrix(A), nnz = 0;
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      nnz += A->matrix[i][j] != 0;
+    }
+  }
+  if (!error) {
+    error = s21_sparse_create(A->rows, A->columns, nnz, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int j = 0; j < A->columns; j++) {
+      if (A->matrix[i][j] != 0) {
+        result->column_index[result->nnz] = j;
+        result->values[result->nnz++] = A->matrix[i][j];
+      }
+    }
+    result->row_start[i + 1] = result->nnz;
+  }
+  return error;
+}
+
+int s21_sparse_to_dense(s21_sparse_t *A, matrix_t *result) {
+  int error = check_bad_sparse(A);
+  if (!error) {
+    error = s21_create_matrix(A->rows, A->columns, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+      result->matrix[i][A->column_index[p]] = A->values[p];
+    }
+  }
+  return error;
+}
+
+// Entries are bucketed by column into A^T, whose transpose then comes out
+// with every row sorted; repeated (row, column) pairs are summed.
+int s21_sparse_from_triplets(int rows, int columns, int count,
+                             const int *row, const int *column,
+                             const double *value, s21_sparse_t *result) {
+  s21_sparse_t At = {0};
+  int error = count < 0 || (count && (!row || !column || !value));
+  for (int k = 0; !error && k < count; k++) {
+    error = row[k] < 0 || row[k] >= rows || column[k] < 0 ||
+            column[k] >= columns;
+  }
+  if (!error) {
+    error = s21_sparse_create(columns, rows, count, &At);
+  }
+  if (!error) {
+    for (int k = 0; k < count; k++) {
+      At.row_start[column[k] + 1]++;
+    }
+    for (int j = 0; j < columns; j++) {
+      At.row_start[j + 1] += At.row_start[j];
+    }
+    for (int k = 0; k < count; k++) {
+      int p = At.row_start[column[k]]++;
+      At.column_index[p] = row[k];
+      At.values[p] = value[k];
+    }
+    for (int j = columns; j > 0; j--) {
+      At.row_start[j] = At.row_start[j - 1];
+    }
+    At.row_start[0] = 0;
+    At.nnz = count;
+    error = s21_sparse_transpose(&At, result);
+  }
+  if (!error) {
+    merge_duplicates(result);
+  }
+  s21_sparse_remove(&At);
+  return error;
+}
+
+// Counting sort by column, so each row of the result is sorted too.
+int s21_sparse_transpose(s21_sparse_t *A, s21_sparse_t *result) {
+  int error = check_bad_sparse(A);
+  if (!error) {
+    error = s21_sparse_create(A->columns, A->rows, A->nnz, result);
+  }
+  if (!error) {
+    int *start = result->row_start;
+    for (int p = 0; p < A->nnz; p++) {
+      start[A->column_index[p] + 1]++;
+    }
+    for (int j = 0; j < A->columns; j++) {
+      start[j + 1] += start[j];
+    }
+    for (int i = 0; i < A->rows; i++) {
+      for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+        int q = start[A->column_index[p]]++;
+        result->column_index[q] = i;
+        result->values[q] = A->values[p];
+      }
+    }
+    for (int j = A->columns; j > 0; j--) {
+      start[j] = start[j - 1];
+    }
+    start[0] = 0;
+    result->nnz = A->nnz;
+  }
+  return error;
+}
+
+int s21_sparse_sum(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result) {
+  return sparse_combine(A, B, 1, result);
+}
+
+int s21_sparse_sub(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result) {
+  return sparse_combine(A, B, -1, result);
+}
+
+// Every row of the result is a sum of rows of B scaled by A's entries,
+// accumulated straight into the dense output.
+int s21_sparse_mult_dense(s21_sparse_t *A, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SPARSE_MULT);
+  int error = check_bad_sparse(A) || check_bad_matrix(B);
+  if (!error && A->columns != B->rows) {
+    error = 2;
+  }
+  if (!error) {
+    error = s21_create_matrix(A->rows, B->columns, result);
+  }
+  if (!error) {
+    spmm_t args = {A, B, result};
+    long row_work = (long)B->columns * (A->nnz / A->rows + 1);
+    parallel_for(A->rows, (int)(SPARSE_GRAIN / row_work) + 1, mult_rows,
+                 &args);
+  }
+  STATS_END(S21_STAT_SPARSE_MULT,
+            error ? 0 : 2.0 * A->nnz * B->columns);
+  return error;
+}
+
+// Gustavson's row-by-row product: one pass sizes the result, a second
+// fills it through a dense accumulator over B's columns.
+int s21_sparse_mult(s21_sparse_t *A, s21_sparse_t *B, s21_sparse_t *result) {
+  STATS_BEGIN(S21_STAT_SPARSE_MULT);
+  int *mark = NULL, error = check_bad_sparse(A) || check_bad_sparse(B);
+  double *sum = NULL, flops = 0;
+  long nnz = 0;
+  if (!error && A->columns != B->rows) {
+    error = 2;
+  }
+  if (!error) {
+    mark = malloc(B->columns * sizeof(int));
+    sum = malloc(B->columns * sizeof(double));
+    error = !mark || !sum;
+  }
+  if (!error) {
+    for (int j = 0; j < B->columns; j++) {
+      mark[j] = -1;
+    }
+    for (int i = 0; i < A->rows; i++) {
+      for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+        int k = A->column_index[p];
+        for (int q = B->row_start[k]; q < B->row_start[k + 1]; q++) {
+          if (mark[B->column_index[q]] != i) {
+            mark[B->column_index[q]] = i;
+            nnz++;
+          }
+        }
+        flops += 2.0 * (B->row_start[k + 1] - B->row_start[k]);
+      }
+    }
+    error = nnz > INT_MAX ? 1 : 0;
+  }
+  if (!error) {
+    error = s21_sparse_create(A->rows, B->columns, (int)nnz, result);
+  }
+  if (!error) {
+    for (int j = 0; j < B->columns; j++) {
+      mark[j] = -1;
+    }
+    for (int i = 0; i < A->rows; i++) {
+      int first = result->nnz;
+      for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+        int k = A->column_index[p];
+        for (int q = B->row_start[k]; q < B->row_start[k + 1]; q++) {
+          int j = B->column_index[q];
+          if (mark[j] != i) {
+            mark[j] = i;
+            sum[j] = 0;
+            result->column_index[result->nnz++] = j;
+          }
+          sum[j] += A->values[p] * B->values[q];
+        }
+      }
+      qsort(result->column_index + first, result->nnz - first, sizeof(int),
+            compare_ints);
+      for (int p = first; p < result->nnz; p++) {
+        result->values[p] = sum[result->column_index[p]];
+      }
+      result->row_start[i + 1] = result->nnz;
+    }
+  }
+  free(mark);
+  free(sum);
+  STATS_END(S21_STAT_SPARSE_MULT, error ? 0 : flops);
+  return error;
+}
+
+// Columns are taken in reverse Cuthill-McKee order of A + A^T and factored
+// left-looking (Gilbert-Peierls): each one is a sparse triangular solve
+// against the columns of L found so far, whose pattern comes from a
+// depth-first search, so the work is proportional to the flops.
+int s21_sparse_lu_factor(s21_sparse_t *A, s21_sparse_lu_t *lu) {
+  STATS_BEGIN(S21_STAT_SPARSE_LU_FACTOR);
+  s21_sparse_t At = {0};
+  double flops = 0;
+  int error = check_bad_sparse(A) || !lu, n = 0;
+  if (lu) {
+    memset(lu, 0, sizeof(*lu));
+  }
+  if (!error) {
+    n = A->rows;
+    error = A->rows == A->columns ? 0 : 2;
+  }
+  if (!error) {
+    error = s21_sparse_transpose(A, &At) ||
+            s21_sparse_create(n, n, A->nnz, &lu->L) ||
+            s21_sparse_create(n, n, A->nnz + n, &lu->U);
+  }
+  if (!error) {
+    s21_allocator_t *a = &lu->L.allocator;
+    lu->p = a->alloc(a->ctx, n * sizeof(int), _Alignof(int));
+    lu->q = a->alloc(a->ctx, n * sizeof(int), _Alignof(int));
+    error = !lu->p || !lu->q;
+  }
+  if (!error) {
+    STATS_ALLOC(2 * n * sizeof(int));
+    error = rcm_order(A, &At, lu->q) || factor_columns(&At, lu, &flops);
+  }
+  if (error && lu) {
+    s21_sparse_lu_remove(lu);
+  }
+  s21_sparse_remove(&At);
+  STATS_END(S21_STAT_SPARSE_LU_FACTOR, error ? 0 : flops);
+  return error;
+}
+
+int s21_sparse_lu_solve(s21_sparse_lu_t *lu, matrix_t *B, matrix_t *result) {
+  STATS_BEGIN(S21_STAT_SPARSE_LU_SOLVE);
+  double *x = NULL;
+  int error = check_bad_sparse_lu(lu) || check_bad_matrix(B);
+  if (!error) {
+    error = (B->rows != lu->U.rows || lu->singular) ? 2 : 0;
+  }
+  if (!error) {
+    x = malloc(B->rows * sizeof(double));
+    error = x ? s21_create_matrix(B->rows, B->columns, result) : 1;
+  }
+  for (int c = 0; !error && c < B->columns; c++) {
+    s21_sparse_t *L = &lu->L, *U = &lu->U;
+    int n = B->rows;
+    for (int k = 0; k < n; k++) {
+      x[k] = B->matrix[lu->p[k]][c];
+    }
+    for (int j = 0; j < n; j++) {
+      for (int p = L->row_start[j]; p < L->row_start[j + 1]; p++) {
+        x[L->column_index[p]] -= L->values[p] * x[j];
+      }
+    }
+    for (int j = n - 1; j >= 0; j--) {
+      int last = U->row_start[j + 1] - 1;
+      x[j] /= U->values[last];
+      for (int p = U->row_start[j]; p < last; p++) {
+        x[U->column_index[p]] -= U->values[p] * x[j];
+      }
+    }
+    for (int k = 0; k < n; k++) {
+      result->matrix[lu->q[k]][c] = x[k];
+    }
+  }
+  free(x);
+  STATS_END(S21_STAT_SPARSE_LU_SOLVE,
+            error ? 0
+                  : 2.0 * (lu->L.nnz + lu->U.nnz) * B->columns);
+  return error;
+}
+
+int s21_sparse_lu_det(s21_sparse_lu_t *lu, double *result) {
+  int error = check_bad_sparse_lu(lu) || !result;
+  if (!error && lu->singular) {
+    *result = 0;
+  } else if (!error) {
+    int n = lu->U.rows, sign_p = permutation_sign(lu->p, n),
+        sign_q = permutation_sign(lu->q, n);
+    error = !sign_p || !sign_q;
+    if (!error) {
+      *result = sign_p * sign_q;
+      for (int k = 0; k < n; k++) {
+        *result *= lu->U.values[lu->U.row_start[k + 1] - 1];
+      }
+    }
+  }
+  return error;
+}
+
+void s21_sparse_lu_remove(s21_sparse_lu_t *lu) {
+  if (lu) {
+    s21_allocator_t *a = &lu->L.allocator;
+    if (lu->p) {
+      a->free(a->ctx, lu->p);
+    }
+    if (lu->q) {
+      a->free(a->ctx, lu->q);
+    }
+    lu->p = NULL;
+    lu->q = NULL;
+    s21_sparse_remove(&lu->L);
+    s21_sparse_remove(&lu->U);
+  }
+}
+
+int s21_sparse_determinant(s21_sparse_t *A, double *result) {
+  s21_sparse_lu_t lu = {0};
+  int error = s21_sparse_lu_factor(A, &lu);
+  if (!error) {
+    error = s21_sparse_lu_det(&lu, result);
+  }
+  s21_sparse_lu_remove(&lu);
+  return error;
+}
+
+int s21_sparse_solve(s21_sparse_t *A, matrix_t *B, matrix_t *result) {
+  s21_sparse_lu_t lu = {0};
+  int error = s21_sparse_lu_factor(A, &lu);
+  if (!error) {
+    error = s21_sparse_lu_solve(&lu, B, result);
+  }
+  s21_sparse_lu_remove(&lu);
+  return error;
+}
+
+static int check_bad_sparse(s21_sparse_t *A) {
+  int error = 0;
+  if (!A || !A->row_start || !A->values || !A->column_index ||
+      A->rows <= 0 || A->columns <= 0) {
+    error = 1;
+  }
+  return error;
+}
+
+static int check_bad_sparse_lu(s21_sparse_lu_t *lu) {
+  int error = 0;
+  if (!lu || !lu->p || !lu->q || check_bad_sparse(&lu->L) ||
+      check_bad_sparse(&lu->U)) {
+    error = 1;
+  }
+  return error;
+}
+
+// Room for at least capacity nonzeros; the stored ones are kept.
+static int sparse_reserve(s21_sparse_t *A, int capacity) {
+  int error = 0;
+  if (capacity > A->capacity || !A->values) {
+    s21_allocator_t *a = &A->allocator;
+    size_t size = capacity > 0 ? capacity : 1;
+    double *values =
+        a->alloc(a->ctx, size * sizeof(double), _Alignof(double));
+    int *column_index = a->alloc(a->ctx, size * sizeof(int), _Alignof(int));
+    error = !values || !column_index;
+    if (!error) {
+      STATS_ALLOC(size * (sizeof(double) + sizeof(int)));
+      if (A->nnz) {
+        memcpy(values, A->values, A->nnz * sizeof(double));
+        memcpy(column_index, A->column_index, A->nnz * sizeof(int));
+      }
+      if (A->values) {
+        a->free(a->ctx, A->values);
+      }
+      if (A->column_index) {
+        a->free(a->ctx, A->column_index);
+      }
+      A->values = values;
+      A->column_index = column_index;
+      A->capacity = (int)size;
+    } else {
+      if (values) {
+        a->free(a->ctx, values);
+      }
+      if (column_index) {
+        a->free(a->ctx, column_index);
+      }
+    }
+  }
+  return error;
+}
+
+// A + sign * B, merging the sorted rows; entries that cancel are kept.
+static int sparse_combine(s21_sparse_t *A, s21_sparse_t *B, double sign,
+                          s21_sparse_t *result) {
+  STATS_BEGIN(sign > 0 ? S21_STAT_SUM : S21_STAT_SUB);
+  int error = check_bad_sparse(A) || check_bad_sparse(B);
+  if (!error && (A->rows != B->rows || A->columns != B->columns)) {
+    error = 2;
+  }
+  if (!error) {
+    error = A->nnz > INT_MAX - B->nnz;
+  }
+  if (!error) {
+    error = s21_sparse_create(A->rows, A->columns, A->nnz + B->nnz, result);
+  }
+  for (int i = 0; !error && i < A->rows; i++) {
+    int p = A->row_start[i], p_end = A->row_start[i + 1];
+    int q = B->row_start[i], q_end = B->row_start[i + 1];
+    while (p < p_end || q < q_end) {
+      int a = p < p_end ? A->column_index[p] : A->columns;
+      int b = q < q_end ? B->column_index[q] : B->columns;
+      double value = 0;
+      if (a <= b) {
+        value += A->values[p++];
+      }
+      if (b <= a) {
+        value += sign * B->values[q++];
+      }
+      result->column_index[result->nnz] = a < b ? a : b;
+      result->values[result->nnz++] = value;
+    }
+    result->row_start[i + 1] = result->nnz;
+  }
+  STATS_END(sign > 0 ? S21_STAT_SUM : S21_STAT_SUB,
+            error ? 0 : result->nnz);
+  return error;
+}
+
+// Sums runs of equal columns within each sorted row, in place.
+static void merge_duplicates(s21_sparse_t *A) {
+  int nnz = 0;
+  for (int i = 0; i < A->rows; i++) {
+    int first = nnz;
+    for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+      if (nnz > first && A->column_index[nnz - 1] == A->column_index[p]) {
+        A->values[nnz - 1] += A->values[p];
+      } else {
+        A->column_index[nnz] = A->column_index[p];
+        A->values[nnz++] = A->values[p];
+      }
+    }
+    A->row_start[i] = first;
+  }
+  A->row_start[A->rows] = nnz;
+  A->nnz = nnz;
+}
+
+// Rows [begin, end) of result = A * B.
+static void mult_rows(void *arg, int begin, int end) {
+  spmm_t *args = arg;
+  s21_sparse_t *A = args->A;
+  int columns = args->B->columns;
+  for (int i = begin; i < end; i++) {
+    double *r = args->result->matrix[i];
+    for (int p = A->row_start[i]; p < A->row_start[i + 1]; p++) {
+      double a = A->values[p];
+      double *b = args->B->matrix[A->column_index[p]];
+      for (int j = 0; j < columns; j++) {
+        r[j] += a * b[j];
+      }
+    }
+  }
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+static int compare_keys(const void *a, const void *b) {
+  long long x = *(const long long *)a, y = *(const long long *)b;
+  return (x > y) - (x < y);
+}
+
+// Reverse Cuthill-McKee on the pattern of A + A^T: breadth-first from an
+// unvisited node of least degree, neighbours queued by increasing degree,
+// and the final order reversed. Nonzeros end up near the diagonal, and the
+// fill of an LU that keeps diagonal pivots stays inside that band.
+static int rcm_order(s21_sparse_t *A, s21_sparse_t *At, int *order) {
+  int n = A->rows, max_degree = 0;
+  int *degree = malloc(n * sizeof(int)), *by_degree = malloc(n * sizeof(int));
+  long long *keys = malloc(n * sizeof(long long));
+  char *visited = calloc(n, 1);
+  int *count = NULL;
+  int error = !degree || !by_degree || !keys || !visited;
+  for (int v = 0; !error && v < n; v++) {
+    degree[v] = A->row_start[v + 1] - A->row_start[v] + At->row_start[v + 1] -
+                At->row_start[v];
+    max_degree = degree[v] > max_degree ? degree[v] : max_degree;
+  }
+  if (!error) {
+    count = calloc(max_degree + 2, sizeof(int));
+    error = !count;
+  }
+  if (!error) {
+    for (int v = 0; v < n; v++) {
+      count[degree[v] + 1]++;
+    }
+    for (int d = 0; d <= max_degree; d++) {
+      count[d + 1] += count[d];
+    }
+    for (int v = 0; v < n; v++) {
+      by_degree[count[degree[v]]++] = v;
+    }
+    int tail = 0;
+    for (int s = 0; s < n; s++) {
+      if (!visited[by_degree[s]]) {
+        visited[by_degree[s]] = 1;
+        order[tail++] = by_degree[s];
+        for (int head = tail - 1; head < tail; head++) {
+          int first = tail;
+          tail = visit_neighbours(A, order[head], order, tail, visited);
+          tail = visit_neighbours(At, order[head], order, tail, visited);
+          for (int t = first; t < tail; t++) {
+            keys[t - first] = (long long)degree[order[t]] * n + order[t];
+          }
+          qsort(keys, tail - first, sizeof(long long), compare_keys);
+          for (int t = first; t < tail; t++) {
+            order[t] = (int)(keys[t - first] % n);
+          }
+        }
+      }
+    }
+    for (int i = 0; i < n / 2; i++) {
+      int temp = order[i];
+      order[i] = order[n - 1 - i];
+      order[n - 1 - i] = temp;
+    }
+  }
+  free(degree);
+  free(by_degree);
+  free(keys);
+  free(visited);
+  free(count);
+  return error;
+}
+
+static int visit_neighbours(s21_sparse_t *A, int v, int *order, int tail,
+                            char *visited) {
+  for (int p = A->row_start[v]; p < A->row_start[v + 1]; p++) {
+    int u = A->column_index[p];
+    if (!visited[u]) {
+      visited[u] = 1;
+      order[tail++] = u;
+    }
+  }
+  return tail;
+}
+
+// Column k of P * A * Q is x = L^-1 * A(:, q[k]) over the rows found by
+// sparse_reach. Entries in rows already pivoted go to U(:, k); the pivot
+// is the largest of the others, or the diagonal row q[k] if it is within
+// SPARSE_PIVOT_TOLERANCE of it, and closes U(:, k); the rest, divided by
+// it, form L(:, k). L and U are kept by column, one CSR row each, with
+// L's unit diagonal implied. Stops at a column with no usable pivot.
+static int factor_columns(s21_sparse_t *At, s21_sparse_lu_t *lu,
+                          double *flops) {
+  s21_sparse_t *L = &lu->L, *U = &lu->U;
+  int n = At->rows, k = 0;
+  double *x = calloc(n, sizeof(double));
+  int *xi = malloc(n * sizeof(int)), *pstack = malloc(n * sizeof(int));
+  int *pinv = lu->p;
+  char *mark = calloc(n, 1);
+  int error = !x || !xi || !pstack || !mark;
+  for (int i = 0; !error && i < n; i++) {
+    pinv[i] = -1;
+  }
+  for (; !error && !lu->singular && k < n; k++) {
+    int column = lu->q[k], pivot = -1;
+    double largest = 0;
+    if (L->capacity - L->nnz < n - k) {
+      error = sparse_reserve(L, 2 * L->capacity + n - k);
+    }
+    if (!error && U->capacity - U->nnz < k + 1) {
+      error = sparse_reserve(U, 2 * U->capacity + k + 1);
+    }
+    int top = error ? n : sparse_reach(L, At, column, xi, pstack, mark, pinv);
+    for (int p = At->row_start[column]; p < At->row_start[column + 1]; p++) {
+      x[At->column_index[p]] = error ? 0 : At->values[p];
+    }
+    for (int px = top; px < n; px++) {
+      int j = xi[px], J = pinv[j];
+      if (J >= 0) {
+        for (int p = L->row_start[J]; p < L->row_start[J + 1]; p++) {
+          x[L->column_index[p]] -= L->values[p] * x[j];
+        }
+        *flops += 2.0 * (L->row_start[J + 1] - L->row_start[J]);
+      }
+    }
+    for (int px = top; px < n; px++) {
+      int i = xi[px];
+      if (pinv[i] >= 0) {
+        U->column_index[U->nnz] = pinv[i];
+        U->values[U->nnz++] = x[i];
+      } else if (fabs(x[i]) > largest) {
+        largest = fabs(x[i]);
+        pivot = i;
+      }
+    }
+    if (pivot < 0) {
+      lu->singular = !error;
+    } else {
+      if (pinv[column] < 0 &&
+          fabs(x[column]) >= SPARSE_PIVOT_TOLERANCE * largest) {
+        pivot = column;
+      }
+      double value = x[pivot];
+      U->column_index[U->nnz] = k;
+      U->values[U->nnz++] = value;
+      pinv[pivot] = k;
+      for (int px = top; px < n; px++) {
+        int i = xi[px];
+        if (pinv[i] < 0) {
+          L->column_index[L->nnz] = i;
+          L->values[L->nnz++] = x[i] / value;
+        }
+      }
+      *flops += n - top;
+    }
+    for (int px = top; px < n; px++) {
+      x[xi[px]] = 0;
+    }
+    L->row_start[k + 1] = L->nnz;
+    U->row_start[k + 1] = U->nnz;
+  }
+  if (!error) {
+    // A singular stop leaves rows unpivoted; they take the last places.
+    int next = 0;
+    for (int i = 0; i < n; i++) {
+      next += pinv[i] >= 0;
+    }
+    for (int i = 0; i < n; i++) {
+      pinv[i] = pinv[i] < 0 ? next++ : pinv[i];
+    }
+    for (int j = k + 1; j <= n; j++) {
+      L->row_start[j] = L->nnz;
+      U->row_start[j] = U->nnz;
+    }
+    for (int p = 0; p < L->nnz; p++) {
+      L->column_index[p] = pinv[L->column_index[p]];
+    }
+    for (int i = 0; i < n; i++) {
+      xi[pinv[i]] = i;
+    }
+    memcpy(lu->p, xi, n * sizeof(int));
+  }
+  free(x);
+  free(xi);
+  free(pstack);
+  free(mark);
+  return error;
+}
+
+// Rows of L^-1 * A(:, column) that can be nonzero, returned in
+// topological order in xi[top, n).
+static int sparse_reach(s21_sparse_t *L, s21_sparse_t *At, int column,
+                        int *xi, int *pstack, char *mark, const int *pinv) {
+  int n = At->rows, top = n;
+  for (int p = At->row_start[column]; p < At->row_start[column + 1]; p++) {
+    if (!mark[At->column_index[p]]) {
+      top = depth_first(L, At->column_index[p], top, xi, pstack, mark, pinv);
+    }
+  }
+  for (int p = top; p < n; p++) {
+    mark[xi[p]] = 0;
+  }
+  return top;
+}
+
+// Iterative search from row j through the columns of L: a pivoted row i
+// leads on to column pinv[i]. xi holds the stack from the bottom and the
+// finished rows from top down; the two never meet, as each row is in one.
+static int depth_first(s21_sparse_t *L, int j, int top, int *xi, int *pstack,
+                       char *mark, const int *pinv) {
+  int head = 0;
+  xi[0] = j;
+  while (head >= 0) {
+    j = xi[head];
+    int J = pinv[j], done = 1;
+    if (!mark[j]) {
+      mark[j] = 1;
+      pstack[head] = J < 0 ? 0 : L->row_start[J];
+    }
+    int end = J < 0 ? 0 : L->row_start[J + 1];
+    for (int p = pstack[head]; p < end && done; p++) {
+      int i = L->column_index[p];
+      if (!mark[i]) {
+        pstack[head] = p + 1;
+        xi[++head] = i;
+        done = 0;
+      }
+    }
+    if (done) {
+      head--;
+      xi[--top] = j;
+    }
+  }
+  return top;
+}
+
+// +1 or -1 by the parity of p's cycles, 0 if the scratch is not available.
+static int permutation_sign(const int *p, int n) {
+  char *seen = calloc(n, 1);
+  int sign = seen ? 1 : 0;
+  for (int i = 0; seen && i < n; i++) {
+    if (!seen[i]) {
+      for (int j = p[i]; j != i; j = p[j]) {
+        seen[j] = 1;
+        sign = -sign;
+      }
+      seen[i] = 1;
+    }
+  }
+  free(seen);
+  return sign;
+}
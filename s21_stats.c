@@ -0,0 +1,131 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdatomic.h>
+#include <time.h>
+
+#include "s21_matrix.h"
+
+// Deepest nesting of instrumented calls tracked per thread; calls below it
+// still count, they only stop receiving inclusive time and bytes.
+#define STATS_DEPTH 16
+
+static const char *const names[S21_STAT_COUNT] = {
+    "create_matrix", "eq_matrix",        "sum_matrix",  "sub_matrix",
+    "mult_number",   "mult_matrix",      "transpose",   "calc_complements",
+    "determinant",   "inverse_matrix",   "lu_factor",   "lu_solve",
+    "lu_det",        "lu_inverse",       "solve",       "cholesky",
+    "cholesky_solve", "sparse_mult",      "sparse_lu_factor",
+    "sparse_lu_solve", "gemm",            "axpby",
+    "solve_mixed"};
+
+#ifdef S21_STATS
+typedef struct counters_struct {
+  atomic_llong calls;
+  atomic_llong flops;
+  atomic_llong bytes;
+  atomic_llong nanoseconds;
+} counters_t;
+
+static counters_t counters[S21_STAT_COUNT];
+static s21_stats_hook begin_hook = NULL;
+static s21_stats_hook end_hook = NULL;
+static void *hook_user = NULL;
+
+static _Thread_local int active[STATS_DEPTH];
+static _Thread_local long long started[STATS_DEPTH];
+static _Thread_local int depth = 0;
+
+static long long now_ns(void);
+#endif
+
+int s21_stats_enabled(void) {
+#ifdef S21_STATS
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+const char *s21_stats_name(int id) {
+  return id >= 0 && id < S21_STAT_COUNT ? names[id] : NULL;
+}
+
+int s21_stats_get(int id, s21_stats_t *stats) {
+  int error = id < 0 || id >= S21_STAT_COUNT || !stats;
+  if (!error) {
+    stats->calls = 0;
+    stats->flops = 0;
+    stats->bytes = 0;
+    stats->seconds = 0;
+#ifdef S21_STATS
+    stats->calls = atomic_load(&counters[id].calls);
+    stats->flops = (double)atomic_load(&counters[id].flops);
+    stats->bytes = atomic_load(&counters[id].bytes);
+    stats->seconds = atomic_load(&counters[id].nanoseconds) * 1e-9;
+#endif
+  }
+  return error;
+}
+
+void s21_stats_reset(void) {
+#ifdef S21_STATS
+  for (int id = 0; id < S21_STAT_COUNT; id++) {
+    atomic_store(&counters[id].calls, 0);
+    atomic_store(&counters[id].flops, 0);
+    atomic_store(&counters[id].bytes, 0);
+    atomic_store(&counters[id].nanoseconds, 0);
+  }
+#endif
+}
+
+void s21_stats_set_hooks(s21_stats_hook begin, s21_stats_hook end,
+                         void *user) {
+#ifdef S21_STATS
+  begin_hook = begin;
+  end_hook = end;
+  hook_user = user;
+#else
+  (void)begin;
+  (void)end;
+  (void)user;
+#endif
+}
+
+#ifdef S21_STATS
+void stats_begin(int id) {
+  if (depth < STATS_DEPTH) {
+    active[depth] = id;
+    started[depth] = now_ns();
+  }
+  depth++;
+  if (begin_hook) {
+    begin_hook(id, hook_user);
+  }
+}
+
+void stats_end(int id, double flops) {
+  depth--;
+  if (depth < STATS_DEPTH) {
+    atomic_fetch_add(&counters[id].nanoseconds, now_ns() - started[depth]);
+  }
+  atomic_fetch_add(&counters[id].calls, 1);
+  atomic_fetch_add(&counters[id].flops, (long long)flops);
+  if (end_hook) {
+    end_hook(id, hook_user);
+  }
+}
+
+// Bytes count towards every call on this thread's stack, so an operation
+// reports the storage of its results and of the calls nested in it.
+void stats_alloc(size_t bytes) {
+  for (int i = 0; i < depth && i < STATS_DEPTH; i++) {
+    atomic_fetch_add(&counters[active[i]].bytes, (long long)bytes);
+  }
+}
+
+static long long now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+#endif
@@ -1,3 +1,5 @@
+#include <stdint.h>
+
 #include "s21_matrix.h"
 
 int check_bad_matrix(matrix_t *A) {
@@ -13,3 +15,34 @@ int check_bad_matrix(matrix_t *A) {
   }
   return error;
 }
+
+// True when the rows follow each other in one block, as s21_create_matrix
+// lays them out, so the whole matrix can be walked as a flat array.
+int is_contiguous(matrix_t *A) {
+  int result = 1;
+  for (int i = 1; i < A->rows && result; i++) {
+    if (A->matrix[i] != A->matrix[0] + (long)i * A->columns) {
+      result = 0;
+    }
+  }
+  return result;
+}
+
+// True when the address ranges spanned by the rows of the two matrices
+// overlap. Products and transposes cannot write over their own operand.
+int check_aliasing(matrix_t *A, matrix_t *result) {
+  uintptr_t a_lo = UINTPTR_MAX, a_hi = 0, r_lo = UINTPTR_MAX, r_hi = 0;
+  for (int i = 0; i < A->rows; i++) {
+    uintptr_t row = (uintptr_t)A->matrix[i];
+    a_lo = row < a_lo ? row : a_lo;
+    a_hi = row > a_hi ? row : a_hi;
+  }
+  for (int i = 0; i < result->rows; i++) {
+    uintptr_t row = (uintptr_t)result->matrix[i];
+    r_lo = row < r_lo ? row : r_lo;
+    r_hi = row > r_hi ? row : r_hi;
+  }
+  a_hi += A->columns * sizeof(double);
+  r_hi += result->columns * sizeof(double);
+  return a_lo < r_hi && r_lo < a_hi;
+}
@@ -0,0 +1,104 @@
+#include "s21_matrix.h"
+
+static int check_view_bounds(matrix_t *A, int row, int column, int rows,
+                             int columns, int row_step, int column_step);
+
+int s21_view_matrix(matrix_t *A, s21_view_t *view) {
+  int error = check_bad_matrix(A) || !view;
+  if (!error) {
+    error = s21_view_block(A, 0, 0, A->rows, A->columns, view);
+  }
+  return error;
+}
+
+int s21_view_block(matrix_t *A, int row, int column, int rows, int columns,
+                   s21_view_t *view) {
+  return s21_view_strided(A, row, column, rows, columns, 1, 1, view);
+}
+
+int s21_view_strided(matrix_t *A, int row, int column, int rows, int columns,
+                     int row_step, int column_step, s21_view_t *view) {
+  int error = check_bad_matrix(A) || !view;
+  if (!error) {
+    error = check_view_bounds(A, row, column, rows, columns, row_step,
+                              column_step);
+  }
+  if (!error) {
+    view->matrix = A->matrix;
+    view->row = row;
+    view->column = column;
+    view->rows = rows;
+    view->columns = columns;
+    view->row_step = row_step;
+    view->column_step = column_step;
+    view->transposed = 0;
+  }
+  return error;
+}
+
+void s21_view_transpose(s21_view_t *view) {
+  if (view) {
+    int rows = view->rows;
+    view->rows = view->columns;
+    view->columns = rows;
+    view->transposed = !view->transposed;
+  }
+}
+
+int s21_view_copy(s21_view_t *view, matrix_t *result) {
+  int error = check_bad_view(view);
+  if (!error) {
+    error = s21_create_matrix(view->rows, view->columns, result);
+  }
+  for (int i = 0; i < view->rows && !error; i++) {
+    for (int j = 0; j < view->columns; j++) {
+      result->matrix[i][j] = *view_at(view, i, j);
+    }
+  }
+  return error;
+}
+
+int check_bad_view(s21_view_t *view) {
+  int error = 0;
+  if (!view || !(view->matrix) || view->rows <= 0 || view->columns <= 0 ||
+      view->row_step <= 0 || view->column_step <= 0) {
+    error = 1;
+  }
+  return error;
+}
+
+// Whole-matrix view for callers that already validated A.
+s21_view_t view_of(matrix_t *A) {
+  s21_view_t view = {A->matrix, 0, 0, A->rows, A->columns, 1, 1, 0};
+  return view;
+}
+
+double *view_at(const s21_view_t *view, int i, int j) {
+  int r = view->transposed ? j : i, c = view->transposed ? i : j;
+  return view->matrix[view->row + (long)r * view->row_step] + view->column +
+         (long)c * view->column_step;
+}
+
+// Block of rows x columns starting at element (i, j) as seen through view.
+s21_view_t view_block(const s21_view_t *view, int i, int j, int rows,
+                      int columns) {
+  s21_view_t block = *view;
+  int r = view->transposed ? j : i, c = view->transposed ? i : j;
+  block.row += r * view->row_step;
+  block.column += c * view->column_step;
+  block.rows = rows;
+  block.columns = columns;
+  return block;
+}
+
+static int check_view_bounds(matrix_t *A, int row, int column, int rows,
+                             int columns, int row_step, int column_step) {
+  int error = 0;
+  if (row < 0 || column < 0 || rows <= 0 || columns <= 0 || row_step <= 0 ||
+      column_step <= 0 ||
+      row + (long long)(rows - 1) * row_step >= A->rows ||
+      column + (long long)(columns - 1) * column_step >= A->columns) {
+    error = 2;
+  }
+  return error;
+}
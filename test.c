@@ -1,7 +1,14 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <check.h>
+#include <float.h>
+#include <math.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "s21_matrix.h"
 
@@ -187,6 +194,60 @@ START_TEST(test_mult_matrix) {
 }
 END_TEST
 
+START_TEST(test_mult_matrix_rect) {
+  matrix_t m1, m2, m3, m4;
+  init_m(2, 3, &m1, 1, 2, 3, 4, 5, 6);
+  init_m(3, 4, &m2, 1, 0, 2, -1, 0, 1, 1, 2, 3, -1, 0, 1);
+  init(&m3);
+  init_m(2, 4, &m4, 10, -1, 4, 6, 22, -1, 13, 12);
+  int res_mult = s21_mult_matrix(&m1, &m2, &m3);
+  ck_assert_int_eq(res_mult, 0);
+  ck_assert_int_eq(m3.rows, 2);
+  ck_assert_int_eq(m3.columns, 4);
+  // LCOV_EXCL_START
+  ck_assert_int_eq(s21_eq_matrix(&m3, &m4), SUCCESS);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&m3);
+  s21_remove_matrix(&m4);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_mult_matrix_large) {
+  int m = 131, k = 270, n = 97;
+  matrix_t m1, m2, m3;
+  s21_create_matrix(m, k, &m1);
+  s21_create_matrix(k, n, &m2);
+  init(&m3);
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < k; j++) {
+      m1.matrix[i][j] = (i * 7 + j * 3) % 11 - 5;
+    }
+  }
+  for (int i = 0; i < k; i++) {
+    for (int j = 0; j < n; j++) {
+      m2.matrix[i][j] = (i * 5 + j) % 13 - 6;
+    }
+  }
+  ck_assert_int_eq(s21_mult_matrix(&m1, &m2, &m3), 0);
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      double sum = 0;
+      for (int l = 0; l < k; l++) {
+        sum += m1.matrix[i][l] * m2.matrix[l][j];
+      }
+      ck_assert_double_eq_tol(m3.matrix[i][j], sum, EPS);
+    }
+  }
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&m3);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
 START_TEST(test_transpose) {
   matrix_t m1, m2, m3;
   init_m(3, 2, &m1, 1, 4, 2, 5, 3, 6);
@@ -384,6 +445,1752 @@ START_TEST(test_inverse) {
 }
 END_TEST
 
+START_TEST(test_inverse_pivot) {
+  matrix_t m1, m2, m3;
+  init_m(3, 3, &m1, 0, 1, 2, 1, 0, 3, 4, -3, 8);
+  init(&m2);
+  init_m(3, 3, &m3, 0, 0, 0, -2, 4, -1, 0, 0, 0);
+  m3.matrix[0][0] = -4.5;
+  m3.matrix[0][1] = 7;
+  m3.matrix[0][2] = -1.5;
+  m3.matrix[2][0] = 1.5;
+  m3.matrix[2][1] = -2;
+  m3.matrix[2][2] = 0.5;
+  int res = s21_inverse_matrix(&m1, &m2);
+  // LCOV_EXCL_START
+  ck_assert_int_eq(s21_eq_matrix(&m2, &m3), SUCCESS);
+  ck_assert_int_eq(res, 0);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&m3);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_inverse_1x1) {
+  matrix_t m1, m2;
+  init_m(1, 1, &m1, 4);
+  init(&m2);
+  int res = s21_inverse_matrix(&m1, &m2);
+  ck_assert_int_eq(res, 0);
+  ck_assert_double_eq_tol(m2.matrix[0][0], 0.25, EPS);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_inverse_singular) {
+  matrix_t m1, m2;
+  init_m(3, 3, &m1, 1, 2, 3, 2, 4, 6, 3, 6, 9);
+  init(&m2);
+  int res = s21_inverse_matrix(&m1, &m2);
+  ck_assert_int_eq(res, 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_inverse_not_square) {
+  matrix_t m1, m2;
+  init_m(2, 3, &m1, 1, 2, 3, 4, 5, 6);
+  init(&m2);
+  int res = s21_inverse_matrix(&m1, &m2);
+  ck_assert_int_eq(res, 2);
+  ck_assert_int_eq(s21_inverse_matrix(NULL, &m2), 1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_lu_solve) {
+  matrix_t m1, b, x, exp;
+  s21_lu_t lu;
+  init_m(3, 3, &m1, 0, 2, 1, 1, -1, 2, 3, 0, 1);
+  init_m(3, 2, &b, 5, 3, 6, 2, 6, 4);
+  init_m(3, 2, &exp, 1, 1, 1, 1, 3, 1);
+  init(&x);
+  int res = s21_lu_factor(&m1, &lu);
+  ck_assert_int_eq(res, 0);
+  ck_assert_int_eq(s21_lu_solve(&lu, &b, &x), 0);
+  // LCOV_EXCL_START
+  ck_assert_int_eq(s21_eq_matrix(&x, &exp), SUCCESS);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&exp);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_lu_det_inverse) {
+  matrix_t m1, m2, m3;
+  s21_lu_t lu;
+  double det;
+  init_m(3, 3, &m1, 2, 5, 7, 6, 3, 4, 5, -2, -3);
+  init(&m2);
+  init_m(3, 3, &m3, 1, -1, 1, -38, 41, -34, 27, -29, 24);
+  ck_assert_int_eq(s21_lu_factor(&m1, &lu), 0);
+  ck_assert_int_eq(s21_lu_det(&lu, &det), 0);
+  ck_assert_double_eq_tol(det, -1, EPS);
+  ck_assert_int_eq(s21_lu_inverse(&lu, &m2), 0);
+  // LCOV_EXCL_START
+  ck_assert_int_eq(s21_eq_matrix(&m2, &m3), SUCCESS);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&m3);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_lu_singular) {
+  matrix_t m1, b, x;
+  s21_lu_t lu;
+  double det;
+  init_m(2, 2, &m1, 1, 2, 2, 4);
+  init_m(2, 1, &b, 1, 1);
+  init(&x);
+  ck_assert_int_eq(s21_lu_factor(&m1, &lu), 0);
+  ck_assert_int_eq(lu.singular, 1);
+  ck_assert_int_eq(s21_lu_det(&lu, &det), 0);
+  ck_assert_double_eq_tol(det, 0, EPS);
+  ck_assert_int_eq(s21_lu_solve(&lu, &b, &x), 2);
+  ck_assert_int_eq(s21_lu_inverse(&lu, &x), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&b);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_lu_inplace) {
+  matrix_t m1, exp;
+  s21_lu_t lu;
+  double det;
+  init_m(3, 3, &m1, 0, 2, 1, 1, -1, 2, 3, 0, 1);
+  init_m(3, 3, &exp, 3, 0, 1, 0, 2, 1, 0, 0, 2);
+  exp.matrix[1][0] = 0;
+  exp.matrix[2][0] = 1.0 / 3;
+  exp.matrix[2][1] = -0.5;
+  exp.matrix[2][2] = 13.0 / 6;
+  double *data = m1.matrix[0];
+  ck_assert_int_eq(s21_lu_factor_inplace(&m1, &lu), 0);
+  ck_assert_ptr_null(m1.matrix);
+  ck_assert_ptr_eq(lu.LU.data, data);
+  ck_assert_int_eq(s21_eq_matrix(&lu.LU, &exp), SUCCESS);
+  ck_assert_int_eq(s21_lu_det(&lu, &det), 0);
+  ck_assert_double_eq_tol(det, 13, EPS);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&exp);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_lu_bad) {
+  matrix_t m1, b, x;
+  s21_lu_t lu;
+  init_m(2, 3, &m1, 1, 2, 3, 4, 5, 6);
+  init(&x);
+  ck_assert_int_eq(s21_lu_factor(&m1, &lu), 2);
+  ck_assert_int_eq(s21_lu_factor(NULL, &lu), 1);
+  ck_assert_int_eq(s21_lu_inverse(&lu, &x), 1);
+  ck_assert_int_eq(s21_lu_solve(NULL, &m1, &x), 1);
+  s21_remove_matrix(&m1);
+  init_m(2, 2, &m1, 1, 2, 3, 4);
+  init_m(3, 1, &b, 1, 1, 1);
+  ck_assert_int_eq(s21_lu_factor(&m1, &lu), 0);
+  ck_assert_int_eq(s21_lu_solve(&lu, &b, &x), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&b);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_num_threads) {
+  s21_set_num_threads(4);
+  ck_assert_int_eq(s21_get_num_threads(), 4);
+  s21_set_num_threads(0);
+  ck_assert_int_eq(s21_get_num_threads(), 1);
+}
+END_TEST
+
+START_TEST(test_parallel_ops) {
+  int n = 300;
+  matrix_t m1, m2, serial, parallel, sum;
+  s21_create_matrix(n, n, &m1);
+  s21_create_matrix(n, n, &m2);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      m1.matrix[i][j] = (i * 7 + j * 3) % 11 - 5 + (i == j) * 40;
+      m2.matrix[i][j] = (i * 5 + j) % 13 - 6;
+    }
+  }
+  s21_set_num_threads(1);
+  ck_assert_int_eq(s21_mult_matrix(&m1, &m2, &serial), 0);
+  s21_set_num_threads(4);
+  ck_assert_int_eq(s21_mult_matrix(&m1, &m2, &parallel), 0);
+  ck_assert_int_eq(s21_eq_matrix(&serial, &parallel), SUCCESS);
+  ck_assert_int_eq(s21_sum_matrix(&m1, &m2, &sum), 0);
+  ck_assert_double_eq_tol(sum.matrix[n - 1][n - 2],
+                          m1.matrix[n - 1][n - 2] + m2.matrix[n - 1][n - 2],
+                          EPS);
+  sum.matrix[n - 1][n - 1] += 1;
+  ck_assert_int_eq(s21_eq_matrix(&sum, &parallel), FAILURE);
+  s21_remove_matrix(&parallel);
+  ck_assert_int_eq(s21_inverse_matrix(&m1, &parallel), 0);
+  s21_remove_matrix(&serial);
+  ck_assert_int_eq(s21_mult_matrix(&m1, &parallel, &serial), 0);
+  for (int i = 0; i < n; i++) {
+    ck_assert_double_eq_tol(serial.matrix[i][i], 1, EPS);
+  }
+  s21_set_num_threads(1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&serial);
+  s21_remove_matrix(&parallel);
+  s21_remove_matrix(&sum);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_simd_levels) {
+  int r = 7, c = 13;
+  matrix_t m1, m2, sum, sub, mult, prod;
+  s21_create_matrix(r, c, &m1);
+  s21_create_matrix(r, c, &m2);
+  for (int i = 0; i < r; i++) {
+    for (int j = 0; j < c; j++) {
+      m1.matrix[i][j] = i * c + j;
+      m2.matrix[i][j] = j - i;
+    }
+  }
+  double *row = m2.matrix[0];
+  m2.matrix[0] = m2.matrix[r - 1];
+  m2.matrix[r - 1] = row;
+  for (int level = S21_SIMD_SCALAR; level <= S21_SIMD_AVX512; level++) {
+    ck_assert_int_le(s21_set_simd_level(level), level);
+    ck_assert_int_eq(s21_sum_matrix(&m1, &m2, &sum), 0);
+    ck_assert_int_eq(s21_sub_matrix(&m1, &m2, &sub), 0);
+    ck_assert_int_eq(s21_mult_number(&m1, -0.5, &mult), 0);
+    for (int i = 0; i < r; i++) {
+      for (int j = 0; j < c; j++) {
+        ck_assert_double_eq_tol(sum.matrix[i][j],
+                                m1.matrix[i][j] + m2.matrix[i][j], EPS);
+        ck_assert_double_eq_tol(sub.matrix[i][j],
+                                m1.matrix[i][j] - m2.matrix[i][j], EPS);
+        ck_assert_double_eq_tol(mult.matrix[i][j], m1.matrix[i][j] * -0.5,
+                                EPS);
+      }
+    }
+    ck_assert_int_eq(s21_eq_matrix(&m1, &m1), SUCCESS);
+    ck_assert_int_eq(s21_eq_matrix(&m1, &sum), FAILURE);
+    sum.matrix[r - 1][c - 1] = m1.matrix[r - 1][c - 1] + 1;
+    ck_assert_int_eq(s21_eq_matrix(&sum, &m1), FAILURE);
+    s21_remove_matrix(&sum);
+    s21_remove_matrix(&sub);
+    s21_remove_matrix(&mult);
+  }
+  s21_set_simd_level(S21_SIMD_SCALAR);
+  ck_assert_int_eq(s21_simd_level(), S21_SIMD_SCALAR);
+  s21_create_matrix(40, 40, &sum);
+  for (int i = 0; i < 40; i++) {
+    for (int j = 0; j < 40; j++) {
+      sum.matrix[i][j] = (i * 3 + j) % 7 - 3;
+    }
+  }
+  ck_assert_int_eq(s21_mult_matrix(&sum, &sum, &prod), 0);
+  s21_set_simd_level(S21_SIMD_AVX512);
+  ck_assert_int_eq(s21_mult_matrix(&sum, &sum, &mult), 0);
+  ck_assert_int_eq(s21_eq_matrix(&prod, &mult), SUCCESS);
+  m2.matrix[r - 1] = m2.matrix[0];
+  m2.matrix[0] = row;
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&sum);
+  s21_remove_matrix(&mult);
+  s21_remove_matrix(&prod);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_into) {
+  matrix_t m1, m2, res, prod, tr, exp;
+  init_m(2, 3, &m1, 1, 2, 3, 4, 5, 6);
+  init_m(2, 3, &m2, 6, 5, 4, 3, 2, 1);
+  s21_create_matrix(2, 3, &res);
+  s21_create_matrix(2, 2, &prod);
+  s21_create_matrix(3, 2, &tr);
+  double *data = res.matrix[0];
+  ck_assert_int_eq(s21_sum_matrix_into(&m1, &m2, &res), 0);
+  init_m(2, 3, &exp, 7, 7, 7, 7, 7, 7);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  ck_assert_int_eq(s21_sub_matrix_into(&m1, &m2, &res), 0);
+  ck_assert_double_eq_tol(res.matrix[1][2], 5, EPS);
+  ck_assert_int_eq(s21_mult_number_into(&m1, 3, &res), 0);
+  ck_assert_double_eq_tol(res.matrix[1][0], 12, EPS);
+  ck_assert_ptr_eq(res.matrix[0], data);
+  // Stale contents, NaN included, are overwritten without being read.
+  prod.matrix[0][0] = NAN;
+  ck_assert_int_eq(s21_transpose_into(&m2, &tr), 0);
+  ck_assert_int_eq(s21_mult_matrix_into(&m1, &tr, &prod), 0);
+  ck_assert_double_eq_tol(prod.matrix[0][0], 28, EPS);
+  ck_assert_double_eq_tol(prod.matrix[1][1], 28, EPS);
+  ck_assert_double_eq_tol(prod.matrix[1][0], 73, EPS);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&prod);
+  s21_remove_matrix(&tr);
+  s21_remove_matrix(&exp);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_into_bad) {
+  matrix_t m1, m2, res;
+  init_m(2, 2, &m1, 1, 2, 3, 4);
+  init_m(2, 2, &m2, 1, 2, 3, 4);
+  s21_create_matrix(2, 3, &res);
+  ck_assert_int_eq(s21_sum_matrix_into(&m1, &m2, &res), 2);
+  ck_assert_int_eq(s21_mult_matrix_into(&m1, &m2, &res), 2);
+  ck_assert_int_eq(s21_transpose_into(&m1, &res), 2);
+  ck_assert_int_eq(s21_mult_number_into(&m1, 2, NULL), 1);
+  ck_assert_int_eq(s21_mult_matrix_into(&m1, &m2, &m1), 2);
+  ck_assert_int_eq(s21_mult_matrix_into(&m1, &m2, &m2), 2);
+  ck_assert_int_eq(s21_transpose_into(&m1, &m1), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&res);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_inplace) {
+  matrix_t m1, m2, exp;
+  init_m(2, 2, &m1, 1, 2, 3, 4);
+  init_m(2, 2, &m2, 4, 3, 2, 1);
+  init_m(2, 2, &exp, 15, 15, 15, 15);
+  ck_assert_int_eq(s21_sum_inplace(&m1, &m2), 0);
+  ck_assert_int_eq(s21_mult_number_inplace(&m1, 4), 0);
+  ck_assert_int_eq(s21_sub_inplace(&m1, &m1), 0);
+  ck_assert_int_eq(s21_sum_inplace(&m1, &exp), 0);
+  ck_assert_int_eq(s21_eq_matrix(&m1, &exp), SUCCESS);
+  ck_assert_int_eq(s21_sum_inplace(&m1, NULL), 1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&exp);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+static int live_blocks = 0;
+
+static void *counting_alloc(void *ctx, size_t size, size_t align) {
+  (void)ctx;
+  (void)align;
+  live_blocks++;
+  return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+  (void)ctx;
+  live_blocks--;
+  free(ptr);
+}
+
+START_TEST(test_allocator) {
+  s21_allocator_t counting = {counting_alloc, counting_free, NULL};
+  matrix_t m1, m2, res;
+  double det = 0;
+  s21_set_allocator(&counting);
+  init_m(3, 3, &m1, 2, 5, 7, 6, 3, 4, 5, -2, -3);
+  ck_assert_int_eq(live_blocks, 2);
+  ck_assert_int_eq(s21_inverse_matrix(&m1, &res), 0);
+  ck_assert_int_eq(s21_calc_complements(&m1, &m2), 0);
+  ck_assert_int_eq(s21_determinant(&m1, &det), 0);
+  ck_assert_int_eq(live_blocks, 6);
+  s21_set_allocator(NULL);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&res);
+  ck_assert_int_eq(live_blocks, 0);
+  // Built by hand with no allocator: freed as malloc'd rows.
+  matrix_t manual = {0};
+  manual.rows = 2;
+  manual.columns = 2;
+  manual.matrix = malloc(2 * sizeof(double *));
+  manual.matrix[0] = calloc(4, sizeof(double));
+  manual.matrix[1] = manual.matrix[0] + 2;
+  s21_remove_matrix(&manual);
+  ck_assert_ptr_null(manual.matrix);
+}
+END_TEST
+
+START_TEST(test_arena) {
+  s21_arena_t arena;
+  matrix_t m1, m2, res;
+  ck_assert_int_eq(s21_arena_init(&arena, 640), 0);
+  s21_allocator_t allocator = s21_arena_allocator(&arena);
+  ck_assert_int_eq(s21_create_matrix_with(4, 4, &allocator, &m1), 0);
+  ck_assert_int_eq(s21_create_matrix_with(4, 4, &allocator, &m2), 0);
+  ck_assert_int_eq((uintptr_t)m1.matrix[0] % _Alignof(double), 0);
+  ck_assert_int_eq(s21_create_matrix_with(8, 8, &allocator, &res), 1);
+  for (int i = 0; i < 4; i++) {
+    m1.matrix[i][i] = 2;
+  }
+  ck_assert_int_eq(s21_mult_number(&m1, 3, &res), 0);
+  ck_assert_ptr_null(res.allocator.ctx);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_arena_reset(&arena);
+  ck_assert_int_eq(arena.used, 0);
+  ck_assert_int_eq(s21_create_matrix_with(8, 8, &allocator, &res), 0);
+  s21_arena_destroy(&arena);
+  ck_assert_int_eq(s21_arena_init(&arena, 0), 1);
+}
+END_TEST
+
+START_TEST(test_create_aligned) {
+  int r = 5, c = 13;
+  matrix_t m1, m2, res;
+  ck_assert_int_eq(s21_create_matrix_aligned(r, c, &m1), 0);
+  ck_assert_int_eq(s21_create_matrix_aligned(0, c, &m2), 1);
+  s21_create_matrix(r, c, &m2);
+  ck_assert_int_eq(m1.ld, 16);
+  ck_assert_int_eq(m2.ld, c);
+  ck_assert_ptr_eq(m2.data, m2.matrix[0]);
+  for (int i = 0; i < r; i++) {
+    ck_assert_int_eq((uintptr_t)m1.matrix[i] % S21_ALIGNMENT, 0);
+    ck_assert_ptr_eq(m1.matrix[i], m1.data + i * m1.ld);
+    for (int j = 0; j < c; j++) {
+      ck_assert_int_eq(m1.matrix[i][j], 0);
+      m1.matrix[i][j] = i - j;
+      m2.matrix[i][j] = i + j;
+    }
+  }
+  ck_assert_int_eq(s21_sum_matrix(&m1, &m2, &res), 0);
+  ck_assert_int_eq(s21_mult_number_inplace(&m1, -1), 0);
+  ck_assert_int_eq(s21_sub_inplace(&res, &m2), 0);
+  ck_assert_int_eq(s21_sum_inplace(&res, &m1), 0);
+  for (int i = 0; i < r; i++) {
+    for (int j = 0; j < c; j++) {
+      ck_assert_double_eq_tol(res.matrix[i][j], 0, EPS);
+    }
+  }
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  s21_remove_matrix(&res);
+  // LCOV_EXCL_STOP
+  ck_assert_ptr_null(m1.data);
+}
+END_TEST
+
+START_TEST(test_transpose_tiled) {
+  int sizes[][2] = {{1, 1}, {3, 5}, {37, 70}, {70, 37}, {64, 64}, {67, 67}};
+  for (int level = S21_SIMD_SCALAR; level <= S21_SIMD_AVX512; level++) {
+    s21_set_simd_level(level);
+    s21_set_num_threads(level % 2 ? 3 : 1);
+    for (int s = 0; s < 6; s++) {
+      int r = sizes[s][0], c = sizes[s][1];
+      matrix_t m1, m2;
+      s21_create_matrix(r, c, &m1);
+      for (int i = 0; i < r; i++) {
+        for (int j = 0; j < c; j++) {
+          m1.matrix[i][j] = i * 1000 + j;
+        }
+      }
+      ck_assert_int_eq(s21_transpose(&m1, &m2), 0);
+      for (int i = 0; i < r; i++) {
+        for (int j = 0; j < c; j++) {
+          ck_assert_double_eq(m2.matrix[j][i], i * 1000 + j);
+        }
+      }
+      ck_assert_int_eq(s21_transpose_inplace(&m1), r == c ? 0 : 2);
+      if (r == c) {
+        ck_assert_int_eq(s21_eq_matrix(&m1, &m2), SUCCESS);
+      }
+      s21_remove_matrix(&m1);
+      s21_remove_matrix(&m2);
+    }
+  }
+  s21_set_num_threads(1);
+  ck_assert_int_eq(s21_transpose_inplace(NULL), 1);
+}
+END_TEST
+
+static int hook_depth = 0;
+static int hook_calls = 0;
+
+static void stats_begin_hook(int id, void *user) {
+  (void)id;
+  (void)user;
+  hook_depth++;
+  hook_calls++;
+}
+
+static void stats_end_hook(int id, void *user) {
+  (void)id;
+  (void)user;
+  hook_depth--;
+}
+
+START_TEST(test_stats) {
+  matrix_t m1, m2;
+  s21_stats_t stats;
+  double det = 0;
+  init_m(5, 5, &m1, 2, 5, 7, 1, 0, 6, 3, 4, 2, 1, 5, -2, -3, 0, 4, 1, 1, 0, 3,
+         2, 0, 4, 1, 2, 6);
+  s21_stats_reset();
+  s21_stats_set_hooks(stats_begin_hook, stats_end_hook, NULL);
+  ck_assert_int_eq(s21_calc_complements(&m1, &m2), 0);
+  s21_stats_set_hooks(NULL, NULL, NULL);
+  ck_assert_int_eq(s21_determinant(&m1, &det), 0);
+  ck_assert_int_eq(s21_stats_get(S21_STAT_DETERMINANT, &stats), 0);
+  if (s21_stats_enabled()) {
+    ck_assert_int_eq(stats.calls, 1);
+    ck_assert_int_eq(hook_depth, 0);
+    ck_assert_int_gt(hook_calls, 3);
+    s21_stats_get(S21_STAT_CALC_COMPLEMENTS, &stats);
+    ck_assert_int_eq(stats.calls, 1);
+    ck_assert_int_ge(stats.bytes, 3 * 25 * (int)sizeof(double));
+    ck_assert(stats.seconds > 0);
+    s21_stats_get(S21_STAT_LU_FACTOR, &stats);
+    ck_assert_int_eq(stats.calls, 2);
+    ck_assert_double_eq_tol(stats.flops, 2 * 2.0 / 3 * 125, 1);
+  } else {
+    ck_assert_int_eq(stats.calls, 0);
+    ck_assert_int_eq(hook_calls, 0);
+  }
+  s21_stats_reset();
+  s21_stats_get(S21_STAT_CALC_COMPLEMENTS, &stats);
+  ck_assert_int_eq(stats.calls, 0);
+  ck_assert_str_eq(s21_stats_name(S21_STAT_LU_SOLVE), "lu_solve");
+  ck_assert_ptr_null(s21_stats_name(S21_STAT_COUNT));
+  ck_assert_int_eq(s21_stats_get(-1, &stats), 1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_view) {
+  matrix_t m1, m2, res, exp;
+  s21_view_t block, strided, trans;
+  double det = 0;
+  init_m(4, 5, &m1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 14, 15, 16, 17,
+         18, 19, 21);
+  ck_assert_int_eq(s21_view_block(&m1, 1, 1, 3, 3, &block), 0);
+  ck_assert_int_eq(s21_view_copy(&block, &res), 0);
+  init_m(3, 3, &exp, 7, 8, 9, 12, 0, 14, 17, 18, 19);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  s21_remove_matrix(&res);
+  ck_assert_int_eq(s21_determinant_view(&block, &det), 0);
+  ck_assert_double_eq_tol(det, 260, EPS);
+  ck_assert_int_eq(s21_sum_view(&block, &block, &res), 0);
+  ck_assert_int_eq(s21_mult_number_inplace(&exp, 2), 0);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&exp);
+
+  ck_assert_int_eq(s21_view_strided(&m1, 0, 0, 2, 3, 2, 2, &strided), 0);
+  s21_view_transpose(&strided);
+  ck_assert_int_eq(s21_mult_number_view(&strided, -1, &res), 0);
+  init_m(3, 2, &exp, -1, -11, -3, 0, -5, -15);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&exp);
+
+  ck_assert_int_eq(s21_view_matrix(&m1, &trans), 0);
+  s21_view_transpose(&trans);
+  ck_assert_int_eq(s21_transpose(&m1, &m2), 0);
+  ck_assert_int_eq(s21_view_matrix(&m2, &block), 0);
+  ck_assert_int_eq(s21_eq_view(&trans, &block), SUCCESS);
+  ck_assert_int_eq(s21_sub_view(&trans, &block, &res), 0);
+  ck_assert_int_eq(s21_mult_matrix_view(&trans, &trans, &exp), 2);
+  ck_assert_int_eq(s21_view_matrix(&m1, &block), 0);
+  s21_remove_matrix(&exp);
+  ck_assert_int_eq(s21_mult_matrix_view(&trans, &block, &exp), 0);
+  s21_remove_matrix(&res);
+  ck_assert_int_eq(s21_mult_matrix(&m2, &m1, &res), 0);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&exp);
+
+  ck_assert_int_eq(s21_view_block(&m1, 2, 3, 3, 1, &block), 2);
+  ck_assert_int_eq(s21_view_block(NULL, 0, 0, 1, 1, &block), 1);
+  ck_assert_int_eq(s21_view_strided(&m1, 0, 0, 2, 2, 0, 1, &block), 2);
+  ck_assert_int_eq(s21_determinant_view(&trans, &det), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m1);
+  s21_remove_matrix(&m2);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_view_mult_large) {
+  int m = 70, k = 90, n = 50;
+  matrix_t a, b, at, bt, res, exp;
+  s21_view_t a_view, b_view;
+  s21_create_matrix(k, m, &a);
+  s21_create_matrix(n, k + 3, &b);
+  for (int i = 0; i < k; i++) {
+    for (int j = 0; j < m; j++) {
+      a.matrix[i][j] = (i * 7 + j * 3) % 11 - 5;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < k + 3; j++) {
+      b.matrix[i][j] = (i * 5 + j) % 13 - 6;
+    }
+  }
+  s21_view_matrix(&a, &a_view);
+  s21_view_transpose(&a_view);
+  s21_view_block(&b, 0, 3, n, k, &b_view);
+  s21_view_transpose(&b_view);
+  ck_assert_int_eq(s21_mult_matrix_view(&a_view, &b_view, &res), 0);
+  ck_assert_int_eq(s21_view_copy(&a_view, &at), 0);
+  ck_assert_int_eq(s21_view_copy(&b_view, &bt), 0);
+  ck_assert_int_eq(s21_mult_matrix(&at, &bt, &exp), 0);
+  ck_assert_int_eq(s21_eq_matrix(&res, &exp), SUCCESS);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&at);
+  s21_remove_matrix(&bt);
+  s21_remove_matrix(&res);
+  s21_remove_matrix(&exp);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+// Every order from 1 to 6 covers the closed forms and the LU fallback;
+// 19 matrices leave a partly filled block of lanes.
+START_TEST(test_batch) {
+  for (int n = 1; n <= 6; n++) {
+    s21_batch_t a, inv;
+    double det[19];
+    ck_assert_int_eq(s21_batch_create(19, n, n, &a), 0);
+    ck_assert_int_eq(s21_batch_create(19, n, n, &inv), 0);
+    for (int b = 0; b < 19; b++) {
+      for (int e = 0; e < n * n; e++) {
+        a.data[b * a.stride + e] = (b * 7 + e * e * 3 + e / n) % 17 - 8 +
+                                   (e % (n + 1) == 0 ? 20 : 0);
+      }
+    }
+    ck_assert_int_eq(s21_batch_determinant(&a, det), 0);
+    ck_assert_int_eq(s21_batch_inverse(&a, &inv), 0);
+    for (int b = 0; b < 19; b++) {
+      matrix_t m, m_inv;
+      double expected = 0;
+      s21_create_matrix(n, n, &m);
+      for (int e = 0; e < n * n; e++) {
+        m.matrix[e / n][e % n] = a.data[b * a.stride + e];
+      }
+      s21_determinant(&m, &expected);
+      ck_assert_double_eq_tol(det[b], expected, 1e-6 * fabs(expected));
+      ck_assert_int_eq(s21_inverse_matrix(&m, &m_inv), 0);
+      for (int e = 0; e < n * n; e++) {
+        ck_assert_double_eq_tol(inv.data[b * inv.stride + e],
+                                m_inv.matrix[e / n][e % n], 1e-9);
+      }
+      // LCOV_EXCL_START
+      s21_remove_matrix(&m);
+      s21_remove_matrix(&m_inv);
+      // LCOV_EXCL_STOP
+    }
+    for (int e = 0; e < n; e++) {
+      a.data[3 * a.stride + e] = 0;
+    }
+    ck_assert_int_eq(s21_batch_inverse(&a, &a), 2);
+    ck_assert_double_eq(a.data[3 * a.stride], 0);
+    // LCOV_EXCL_START
+    s21_batch_remove(&a);
+    s21_batch_remove(&inv);
+    // LCOV_EXCL_STOP
+  }
+}
+END_TEST
+
+// Workers must not allocate through the installed allocator: an arena is
+// not thread-safe, and this one is too small to hold any scratch.
+START_TEST(test_batch_arena) {
+  int n = 40, count = 64;
+  s21_batch_t a, inv;
+  s21_arena_t arena;
+  matrix_t m, m_inv;
+  s21_batch_create(count, n, n, &a);
+  s21_batch_create(count, n, n, &inv);
+  for (int b = 0; b < count; b++) {
+    for (int e = 0; e < n * n; e++) {
+      a.data[b * a.stride + e] = (b + e * 7) % 13 - 6 + (e % (n + 1) ? 0 : 60);
+    }
+  }
+  s21_arena_init(&arena, 64);
+  s21_allocator_t allocator = s21_arena_allocator(&arena);
+  s21_set_num_threads(4);
+  s21_set_allocator(&allocator);
+  ck_assert_int_eq(s21_batch_inverse(&a, &inv), 0);
+  s21_set_allocator(NULL);
+  s21_set_num_threads(0);
+  ck_assert_int_eq(arena.used, 0);
+  s21_create_matrix(n, n, &m);
+  for (int e = 0; e < n * n; e++) {
+    m.matrix[e / n][e % n] = a.data[(count - 1) * a.stride + e];
+  }
+  ck_assert_int_eq(s21_inverse_matrix(&m, &m_inv), 0);
+  for (int e = 0; e < n * n; e++) {
+    ck_assert_double_eq_tol(inv.data[(count - 1) * inv.stride + e],
+                            m_inv.matrix[e / n][e % n], 1e-9);
+  }
+  s21_remove_matrix(&m);
+  s21_remove_matrix(&m_inv);
+  s21_arena_destroy(&arena);
+  s21_batch_remove(&a);
+  s21_batch_remove(&inv);
+}
+END_TEST
+
+START_TEST(test_batch_mult) {
+  int shapes[2][3] = {{3, 4, 2}, {9, 5, 10}};
+  for (int s = 0; s < 2; s++) {
+    int m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+    double buffer[11 * 10 * 10] = {0};
+    s21_batch_t a, b = {buffer, 11, k, n, 100, {0}}, c;
+    ck_assert_int_eq(s21_batch_create(11, m, k, &a), 0);
+    ck_assert_int_eq(s21_batch_create(11, m, n, &c), 0);
+    for (int i = 0; i < 11 * m * k; i++) {
+      a.data[i] = i % 7 - 3;
+    }
+    for (int i = 0; i < 11 * 100; i++) {
+      buffer[i] = i % 5 - 2;
+    }
+    ck_assert_int_eq(s21_batch_mult(&a, &b, &c), 0);
+    for (int t = 0; t < 11; t++) {
+      for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+          double expected = 0;
+          for (int p = 0; p < k; p++) {
+            expected += a.data[t * a.stride + i * k + p] *
+                        buffer[t * 100 + p * n + j];
+          }
+          ck_assert_double_eq(c.data[t * c.stride + i * n + j], expected);
+        }
+      }
+    }
+    ck_assert_int_eq(s21_batch_mult(&b, &a, &c), 2);
+    b.stride = k * n - 1;
+    ck_assert_int_eq(s21_batch_mult(&a, &b, &c), 1);
+    // LCOV_EXCL_START
+    s21_batch_remove(&a);
+    s21_batch_remove(&c);
+    // LCOV_EXCL_STOP
+  }
+  double det;
+  s21_batch_t empty = {NULL, 1, 2, 2, 4, {0}}, rect;
+  s21_batch_create(2, 2, 3, &rect);
+  ck_assert_int_eq(s21_batch_determinant(&empty, &det), 1);
+  ck_assert_int_eq(s21_batch_determinant(&rect, &det), 2);
+  ck_assert_int_eq(s21_batch_create(0, 2, 2, &empty), 1);
+  s21_batch_remove(&rect);
+}
+END_TEST
+
+// The closed forms are checked against the LU factorization, which still
+// handles every order the general way.
+START_TEST(test_small_fixed) {
+  s21_mat2_t a2 = {{{3, -1}, {4, 2}}}, r2;
+  s21_mat3_t a3 = {{{2, 5, 7}, {6, 3, 4}, {5, -2, -3}}}, r3;
+  s21_mat4_t a4 = {{{2, 1, 0, 3}, {1, -3, 2, 1}, {0, 2, 5, -1}, {4, 1, 1, 2}}};
+  s21_mat4_t r4;
+  double *small[3] = {&a2.m[0][0], &a3.m[0][0], &a4.m[0][0]};
+  for (int n = 2; n <= 4; n++) {
+    matrix_t m, inv, comp;
+    s21_lu_t lu;
+    double det = 0, expected = 0, got[16];
+    s21_create_matrix(n, n, &m);
+    for (int e = 0; e < n * n; e++) {
+      m.matrix[e / n][e % n] = small[n - 2][e];
+    }
+    s21_lu_factor(&m, &lu);
+    s21_lu_det(&lu, &expected);
+    s21_lu_inverse(&lu, &inv);
+    if (n == 2) {
+      ck_assert_int_eq(s21_mat2_determinant(&a2, &det), 0);
+      ck_assert_int_eq(s21_mat2_inverse(&a2, &r2), 0);
+      memcpy(got, r2.m, sizeof(r2.m));
+    } else if (n == 3) {
+      ck_assert_int_eq(s21_mat3_determinant(&a3, &det), 0);
+      ck_assert_int_eq(s21_mat3_inverse(&a3, &r3), 0);
+      memcpy(got, r3.m, sizeof(r3.m));
+    } else {
+      ck_assert_int_eq(s21_mat4_determinant(&a4, &det), 0);
+      ck_assert_int_eq(s21_mat4_inverse(&a4, &r4), 0);
+      memcpy(got, r4.m, sizeof(r4.m));
+    }
+    ck_assert_double_eq_tol(det, expected, 1e-9);
+    ck_assert_int_eq(s21_calc_complements(&m, &comp), 0);
+    for (int e = 0; e < n * n; e++) {
+      int i = e / n, j = e % n;
+      ck_assert_double_eq_tol(got[e], inv.matrix[i][j], 1e-12);
+      ck_assert_double_eq_tol(comp.matrix[i][j], inv.matrix[j][i] * det,
+                              1e-9);
+    }
+    // LCOV_EXCL_START
+    s21_remove_matrix(&m);
+    s21_remove_matrix(&inv);
+    s21_remove_matrix(&comp);
+    s21_lu_remove(&lu);
+    // LCOV_EXCL_STOP
+  }
+  ck_assert_int_eq(s21_mat3_complements(&a3, &a3), 0);
+  ck_assert_double_eq(a3.m[0][0], -1);
+  ck_assert_double_eq(a3.m[1][0], 1);
+  ck_assert_int_eq(s21_mat2_complements(&a2, &r2), 0);
+  ck_assert_double_eq(r2.m[0][1], -4);
+  ck_assert_int_eq(s21_mat4_complements(&a4, NULL), 1);
+  s21_mat2_t singular = {{{1, 2}, {2, 4}}};
+  ck_assert_int_eq(s21_mat2_inverse(&singular, &singular), 2);
+  ck_assert_double_eq(singular.m[1][1], 4);
+}
+END_TEST
+
+START_TEST(test_fast) {
+  for (int aligned = 0; aligned < 2; aligned++) {
+    matrix_t a, b, r, exp;
+    int (*create)(int, int, matrix_t *) =
+        aligned ? s21_create_matrix_aligned : s21_create_matrix;
+    create(5, 7, &a);
+    create(5, 7, &b);
+    create(5, 7, &r);
+    for (int i = 0; i < 5; i++) {
+      for (int j = 0; j < 7; j++) {
+        a.matrix[i][j] = i * 7 + j - 10;
+        b.matrix[i][j] = (i * 3 + j) % 4 * 0.5;
+      }
+    }
+    ck_assert_int_eq(s21_fast_eq(&a, &a), SUCCESS);
+    ck_assert_int_eq(s21_fast_eq(&a, &b), FAILURE);
+    s21_fast_sum(&a, &b, &r);
+    s21_sum_matrix(&a, &b, &exp);
+    ck_assert_int_eq(s21_eq_matrix(&r, &exp), SUCCESS);
+    s21_remove_matrix(&exp);
+    s21_fast_sub(&a, &b, &r);
+    s21_sub_matrix(&a, &b, &exp);
+    ck_assert_int_eq(s21_eq_matrix(&r, &exp), SUCCESS);
+    s21_remove_matrix(&exp);
+    s21_fast_mult_number(&a, -2, &a);
+    ck_assert_double_eq(a.matrix[4][6], -48);
+    s21_remove_matrix(&r);
+    create(7, 5, &r);
+    s21_fast_transpose(&a, &r);
+    ck_assert_double_eq(r.matrix[6][4], -48);
+    s21_remove_matrix(&b);
+    create(5, 5, &b);
+    b.matrix[4][4] = 1;
+    s21_fast_mult_matrix(&a, &r, &b);
+    s21_mult_matrix(&a, &r, &exp);
+    ck_assert_int_eq(s21_eq_matrix(&b, &exp), SUCCESS);
+    // LCOV_EXCL_START
+    s21_remove_matrix(&a);
+    s21_remove_matrix(&b);
+    s21_remove_matrix(&r);
+    s21_remove_matrix(&exp);
+    // LCOV_EXCL_STOP
+  }
+}
+END_TEST
+
+// 150 rows span several TRSM blocks; the residual is checked column-wise.
+START_TEST(test_solve) {
+  int n = 150, m = 37;
+  matrix_t a, b, x, ax, small, rhs;
+  s21_create_matrix(n, n, &a);
+  s21_create_matrix(n, m, &b);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a.matrix[i][j] = (i * 7 + j * 13) % 17 - 8 + (i == j) * 3;
+    }
+    for (int j = 0; j < m; j++) {
+      b.matrix[i][j] = (i + j * 5) % 9 - 4;
+    }
+  }
+  ck_assert_int_eq(s21_solve(&a, &b, &x), 0);
+  ck_assert_int_eq(s21_mult_matrix(&a, &x, &ax), 0);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      ck_assert_double_eq_tol(ax.matrix[i][j], b.matrix[i][j], 1e-8);
+    }
+  }
+  init_m(3, 3, &small, 2, 1, -1, -3, -1, 2, -2, 1, 2);
+  init_m(3, 1, &rhs, 8, -11, -3);
+  s21_remove_matrix(&x);
+  ck_assert_int_eq(s21_solve(&small, &rhs, &x), 0);
+  ck_assert_double_eq_tol(x.matrix[0][0], 2, 1e-12);
+  ck_assert_double_eq_tol(x.matrix[1][0], 3, 1e-12);
+  ck_assert_double_eq_tol(x.matrix[2][0], -1, 1e-12);
+  ck_assert_int_eq(s21_solve(&a, &rhs, &ax), 2);
+  ck_assert_int_eq(s21_solve(&b, &b, &ax), 2);
+  ck_assert_int_eq(s21_solve(&small, NULL, &ax), 1);
+  small.matrix[2][0] = 0;
+  small.matrix[2][1] = 0;
+  small.matrix[2][2] = 0;
+  ck_assert_int_eq(s21_solve(&small, &rhs, &ax), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&ax);
+  s21_remove_matrix(&small);
+  s21_remove_matrix(&rhs);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+// A = (M * M^T + n * I) / 100 is SPD with a determinant that fits in a
+// double; 150 rows take several blocks.
+START_TEST(test_cholesky) {
+  int n = 150;
+  matrix_t m, a, l, lt, llt, b, x, ax, inv, lu_inv;
+  double det = 0, lu_det = 0;
+  s21_lu_t lu;
+  s21_create_matrix(n, n, &m);
+  s21_create_matrix(n, 3, &b);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      m.matrix[i][j] = ((i * 7 + j * 13) % 17 - 8) / 8.0;
+    }
+    for (int j = 0; j < 3; j++) {
+      b.matrix[i][j] = (i + j * 5) % 9 - 4;
+    }
+  }
+  s21_transpose(&m, &lt);
+  s21_mult_matrix(&m, &lt, &a);
+  s21_remove_matrix(&lt);
+  for (int i = 0; i < n; i++) {
+    a.matrix[i][i] += n;
+  }
+  s21_mult_number_inplace(&a, 0.01);
+  ck_assert_int_eq(s21_cholesky(&a, &l), 0);
+  ck_assert_double_eq(l.matrix[0][1], 0);
+  s21_transpose(&l, &lt);
+  s21_mult_matrix(&l, &lt, &llt);
+  ck_assert_int_eq(s21_eq_matrix(&llt, &a), SUCCESS);
+  ck_assert_int_eq(s21_cholesky_solve(&l, &b, &x), 0);
+  s21_mult_matrix(&a, &x, &ax);
+  ck_assert_int_eq(s21_eq_matrix(&ax, &b), SUCCESS);
+  s21_lu_factor(&a, &lu);
+  s21_lu_det(&lu, &lu_det);
+  s21_lu_inverse(&lu, &lu_inv);
+  ck_assert_int_eq(s21_cholesky_det(&l, &det), 0);
+  ck_assert_double_eq_tol(det / lu_det, 1, 1e-9);
+  ck_assert_int_eq(s21_determinant(&a, &det), 0);
+  ck_assert_double_eq_tol(det / lu_det, 1, 1e-9);
+  ck_assert_int_eq(s21_cholesky_inverse(&l, &inv), 0);
+  ck_assert_int_eq(s21_eq_matrix(&inv, &lu_inv), SUCCESS);
+  s21_remove_matrix(&inv);
+  ck_assert_int_eq(s21_inverse_matrix(&a, &inv), 0);
+  ck_assert_int_eq(s21_eq_matrix(&inv, &lu_inv), SUCCESS);
+  ck_assert_int_eq(s21_cholesky_solve(&l, NULL, &x), 1);
+  ck_assert_int_eq(s21_cholesky_solve(&b, &b, &x), 2);
+  s21_remove_matrix(&lt);
+  a.matrix[n - 1][n - 1] = -1;
+  ck_assert_int_eq(s21_cholesky(&a, &lt), 2);
+  ck_assert_int_eq(s21_cholesky(&b, &lt), 2);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&m);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&l);
+  s21_remove_matrix(&lt);
+  s21_remove_matrix(&llt);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&ax);
+  s21_remove_matrix(&inv);
+  s21_remove_matrix(&lu_inv);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+// A is built as L * U with known pivots and its rows reversed, so the
+// blocked factorization has to pivot across panels; det(A) is the product
+// of U's diagonal times the sign of the reversal.
+START_TEST(test_lu_blocked) {
+  int n = 130;
+  matrix_t l, u, lu_prod, a;
+  s21_lu_t lu;
+  double det = 0, expected = n * (n - 1) / 2 % 2 ? -1 : 1;
+  s21_create_matrix(n, n, &l);
+  s21_create_matrix(n, n, &u);
+  s21_create_matrix(n, n, &a);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < i; j++) {
+      l.matrix[i][j] = ((i + j) % 5 - 2) / 16.0;
+    }
+    l.matrix[i][i] = 1;
+    u.matrix[i][i] = 1 + i % 3 / 2.0;
+    expected *= u.matrix[i][i];
+    for (int j = i + 1; j < n; j++) {
+      u.matrix[i][j] = ((i * j) % 7 - 3) / 24.0;
+    }
+  }
+  s21_mult_matrix(&l, &u, &lu_prod);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a.matrix[n - 1 - i][j] = lu_prod.matrix[i][j];
+    }
+  }
+  ck_assert_int_eq(s21_lu_factor(&a, &lu), 0);
+  ck_assert_int_eq(lu.singular, 0);
+  s21_lu_det(&lu, &det);
+  ck_assert_double_eq_tol(det / expected, 1, 1e-9);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      double sum = 0;
+      for (int k = 0; k <= (i < j ? i : j); k++) {
+        sum += (k == i ? 1 : lu.LU.matrix[i][k]) * lu.LU.matrix[k][j];
+      }
+      ck_assert_double_eq_tol(sum, a.matrix[lu.p[i]][j], 1e-9);
+    }
+  }
+  s21_lu_remove(&lu);
+  for (int i = 0; i < n; i++) {
+    a.matrix[i][100] = 0;
+  }
+  ck_assert_int_eq(s21_lu_factor(&a, &lu), 0);
+  ck_assert_int_eq(lu.singular, 1);
+  ck_assert_int_eq(s21_determinant(&a, &det), 0);
+  ck_assert_double_eq(det, 0);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&l);
+  s21_remove_matrix(&u);
+  s21_remove_matrix(&lu_prod);
+  s21_remove_matrix(&a);
+  s21_lu_remove(&lu);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+// Orders above 4 go through det(A) * (A^-1)^T, or through one complete
+// pivoting factorization when a duplicated row makes A singular; both are
+// checked against cofactors taken minor by minor.
+START_TEST(test_complements_adjugate) {
+  int n = 6;
+  matrix_t a, comp, minor;
+  s21_create_matrix(n, n, &a);
+  s21_create_matrix(n - 1, n - 1, &minor);
+  for (int rank = n; rank >= n - 2; rank--) {
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        a.matrix[i][j] = (i * j + 1) % 7 - 3 + (i == j) * 4;
+      }
+    }
+    for (int j = 0; j < n && rank < n; j++) {
+      a.matrix[4][j] = a.matrix[1][j];
+      a.matrix[5][j] = rank < n - 1 ? a.matrix[2][j] : a.matrix[5][j];
+    }
+    ck_assert_int_eq(s21_calc_complements(&a, &comp), 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        double det = 0;
+        for (int k = 0; k < n - 1; k++) {
+          for (int l = 0; l < n - 1; l++) {
+            minor.matrix[k][l] = a.matrix[k + (k >= i)][l + (l >= j)];
+          }
+        }
+        s21_determinant(&minor, &det);
+        det *= (i + j) % 2 ? -1 : 1;
+        ck_assert_double_eq_tol(comp.matrix[i][j], det, 1e-9);
+        ck_assert(rank == n - 1 || rank == n || comp.matrix[i][j] == 0);
+      }
+    }
+    s21_remove_matrix(&comp);
+  }
+  // LCOV_EXCL_START
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&minor);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_sparse) {
+  matrix_t a, b, dense, expected;
+  s21_sparse_t sa, sb, sr;
+  s21_create_matrix(7, 9, &a);
+  s21_create_matrix(9, 7, &b);
+  for (int i = 0; i < 7; i++) {
+    for (int j = 0; j < 9; j++) {
+      a.matrix[i][j] = (i * 3 + j) % 4 ? 0 : i - j + 0.5;
+      b.matrix[j][i] = (i + j * 5) % 3 ? 0 : i * j - 2.0;
+    }
+  }
+  ck_assert_int_eq(s21_sparse_from_dense(&a, &sa), 0);
+  ck_assert_int_lt(sa.nnz, 7 * 9 / 2);
+  ck_assert_int_eq(s21_sparse_to_dense(&sa, &dense), 0);
+  ck_assert_int_eq(s21_eq_matrix(&a, &dense), SUCCESS);
+  s21_remove_matrix(&dense);
+  ck_assert_int_eq(s21_sparse_from_dense(&b, &sb), 0);
+  ck_assert_int_eq(s21_sparse_mult_dense(&sa, &b, &dense), 0);
+  s21_mult_matrix(&a, &b, &expected);
+  ck_assert_int_eq(s21_eq_matrix(&expected, &dense), SUCCESS);
+  s21_remove_matrix(&dense);
+  ck_assert_int_eq(s21_sparse_mult(&sa, &sb, &sr), 0);
+  s21_sparse_to_dense(&sr, &dense);
+  ck_assert_int_eq(s21_eq_matrix(&expected, &dense), SUCCESS);
+  for (int i = 0; i < sr.rows; i++) {
+    for (int p = sr.row_start[i] + 1; p < sr.row_start[i + 1]; p++) {
+      ck_assert_int_lt(sr.column_index[p - 1], sr.column_index[p]);
+    }
+  }
+  s21_remove_matrix(&dense);
+  s21_remove_matrix(&expected);
+  s21_sparse_remove(&sr);
+  s21_sparse_remove(&sb);
+  ck_assert_int_eq(s21_sparse_transpose(&sa, &sb), 0);
+  s21_sparse_to_dense(&sb, &dense);
+  s21_transpose(&a, &expected);
+  ck_assert_int_eq(s21_eq_matrix(&expected, &dense), SUCCESS);
+  s21_remove_matrix(&dense);
+  s21_remove_matrix(&expected);
+  ck_assert_int_eq(s21_sparse_sum(&sa, &sb, &sr), 2);
+  ck_assert_int_eq(s21_sparse_mult(&sa, &sa, &sr), 2);
+  ck_assert_int_eq(s21_sparse_mult_dense(&sa, &a, &dense), 2);
+  s21_sparse_remove(&sb);
+  int row[] = {6, 0, 6, 3, 0}, column[] = {8, 2, 8, 0, 2};
+  double value[] = {1, 2, 3, 4, -2};
+  ck_assert_int_eq(
+      s21_sparse_from_triplets(7, 9, 5, row, column, value, &sb), 0);
+  ck_assert_int_eq(sb.nnz, 3);
+  ck_assert_int_eq(s21_sparse_sub(&sa, &sb, &sr), 0);
+  s21_sparse_to_dense(&sr, &dense);
+  a.matrix[6][8] -= 4;
+  a.matrix[3][0] -= 4;
+  ck_assert_int_eq(s21_eq_matrix(&a, &dense), SUCCESS);
+  column[0] = 9;
+  s21_sparse_remove(&sr);
+  ck_assert_int_eq(
+      s21_sparse_from_triplets(7, 9, 5, row, column, value, &sr), 1);
+  ck_assert_int_eq(s21_sparse_create(0, 3, 1, &sr), 1);
+  ck_assert_int_eq(s21_sparse_to_dense(NULL, &dense), 1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&dense);
+  s21_sparse_remove(&sa);
+  s21_sparse_remove(&sb);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+// A convection-diffusion operator on a k x k grid: five points per row,
+// not symmetric, and numbered so that its bandwidth is poor until RCM.
+START_TEST(test_sparse_lu) {
+  int k = 15, n = k * k, count = 0;
+  int *row = malloc(5 * n * sizeof(int)), *column = malloc(5 * n * sizeof(int));
+  double *value = malloc(5 * n * sizeof(double)), det = 0, expected = 0;
+  matrix_t x, b, solution, dense;
+  s21_sparse_t a;
+  s21_sparse_lu_t lu;
+  for (int v = 0; v < n; v++) {
+    int i = v / k, j = v % k, node = v * 7 % n;
+    int neighbour[] = {i > 0 ? v - k : -1, i < k - 1 ? v + k : -1,
+                       j > 0 ? v - 1 : -1, j < k - 1 ? v + 1 : -1};
+    double weight[] = {-1.2, -0.8, -1.1, -0.9};
+    row[count] = node;
+    column[count] = node;
+    value[count++] = 4.5;
+    for (int d = 0; d < 4; d++) {
+      if (neighbour[d] >= 0) {
+        row[count] = node;
+        column[count] = neighbour[d] * 7 % n;
+        value[count++] = weight[d];
+      }
+    }
+  }
+  ck_assert_int_eq(
+      s21_sparse_from_triplets(n, n, count, row, column, value, &a), 0);
+  s21_create_matrix(n, 2, &x);
+  for (int v = 0; v < n; v++) {
+    x.matrix[v][0] = v % 5 - 2;
+    x.matrix[v][1] = 1.0 / (v + 1);
+  }
+  s21_sparse_mult_dense(&a, &x, &b);
+  ck_assert_int_eq(s21_sparse_lu_factor(&a, &lu), 0);
+  ck_assert_int_eq(lu.singular, 0);
+  ck_assert_int_lt(lu.L.nnz + lu.U.nnz, n * n / 4);
+  ck_assert_int_eq(s21_sparse_lu_solve(&lu, &b, &solution), 0);
+  for (int v = 0; v < n; v++) {
+    ck_assert_double_eq_tol(solution.matrix[v][0], x.matrix[v][0], 1e-9);
+    ck_assert_double_eq_tol(solution.matrix[v][1], x.matrix[v][1], 1e-9);
+  }
+  s21_remove_matrix(&solution);
+  s21_sparse_lu_remove(&lu);
+  s21_sparse_remove(&a);
+  // Small enough for a dense determinant; the zero diagonal forces pivots
+  // off it.
+  s21_create_matrix(9, 9, &dense);
+  for (int i = 0; i < 9; i++) {
+    dense.matrix[i][(i + 4) % 9] = 2 + i % 3;
+    dense.matrix[i][(i + 1) % 9] = i % 2 ? 1 : -1.5;
+    dense.matrix[i][(i * 2) % 9] += 0.25;
+  }
+  dense.matrix[0][0] = 0;
+  s21_sparse_from_dense(&dense, &a);
+  ck_assert_int_eq(s21_sparse_determinant(&a, &det), 0);
+  s21_determinant(&dense, &expected);
+  ck_assert_double_eq_tol(det / expected, 1, 1e-12);
+  s21_remove_matrix(&b);
+  s21_create_matrix(9, 1, &b);
+  b.matrix[3][0] = 1;
+  ck_assert_int_eq(s21_sparse_solve(&a, &b, &solution), 0);
+  s21_remove_matrix(&x);
+  s21_mult_matrix(&dense, &solution, &x);
+  for (int i = 0; i < 9; i++) {
+    ck_assert_double_eq_tol(x.matrix[i][0], b.matrix[i][0], 1e-12);
+  }
+  s21_sparse_remove(&a);
+  for (int j = 0; j < 9; j++) {
+    dense.matrix[5][j] = dense.matrix[2][j];
+  }
+  s21_sparse_from_dense(&dense, &a);
+  ck_assert_int_eq(s21_sparse_lu_factor(&a, &lu), 0);
+  ck_assert_int_eq(lu.singular, 1);
+  ck_assert_int_eq(s21_sparse_lu_det(&lu, &det), 0);
+  ck_assert_double_eq(det, 0);
+  s21_remove_matrix(&solution);
+  ck_assert_int_eq(s21_sparse_lu_solve(&lu, &b, &solution), 2);
+  ck_assert_int_eq(s21_sparse_lu_solve(NULL, &b, &solution), 1);
+  // LCOV_EXCL_START
+  s21_sparse_lu_remove(&lu);
+  s21_sparse_remove(&a);
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&dense);
+  free(row);
+  free(column);
+  free(value);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_mmap_matrix) {
+  const char *path = "s21_test_matrix.bin";
+  matrix_t a, mapped, again;
+  s21_lu_t lu;
+  ck_assert_int_eq(s21_create_matrix_aligned(5, 7, &a), 0);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 7; j++) {
+      a.matrix[i][j] = (i * 7 + j) % 6 - 2.5 + (i == j) * 9;
+    }
+  }
+  ck_assert_int_eq(s21_save_matrix(&a, path), 0);
+  ck_assert_int_eq(s21_mmap_matrix(path, &mapped), 0);
+  ck_assert_int_eq(mapped.ld, a.ld);
+  ck_assert_int_eq((uintptr_t)mapped.data % S21_ALIGNMENT, 0);
+  ck_assert_int_eq(s21_eq_matrix(&a, &mapped), SUCCESS);
+  mapped.matrix[1][2] = 100;
+  ck_assert_int_eq(s21_mmap_matrix(path, &again), 0);
+  ck_assert_double_eq(again.matrix[1][2], a.matrix[1][2]);
+  s21_remove_matrix(&mapped);
+  s21_remove_matrix(&again);
+  s21_remove_matrix(&a);
+  // Row pointers swapped by pivoting are saved in their logical order, and
+  // the mapped storage can be factored in place.
+  s21_create_matrix(6, 6, &a);
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      a.matrix[i][j] = (i * 5 + j * 3) % 7 + (i + j == 5) * 8;
+    }
+  }
+  ck_assert_int_eq(s21_lu_factor(&a, &lu), 0);
+  ck_assert_int_eq(s21_save_matrix(&lu.LU, path), 0);
+  ck_assert_int_eq(s21_mmap_matrix(path, &mapped), 0);
+  ck_assert_int_eq(s21_eq_matrix(&lu.LU, &mapped), SUCCESS);
+  s21_lu_remove(&lu);
+  ck_assert_int_eq(s21_lu_factor_inplace(&mapped, &lu), 0);
+  s21_lu_remove(&lu);
+  FILE *f = fopen(path, "r+b");
+  fseek(f, 8, SEEK_SET);
+  fputc(S21_FILE_VERSION + 1, f);
+  fclose(f);
+  ck_assert_int_eq(s21_mmap_matrix(path, &mapped), 1);
+  ck_assert_int_eq(s21_save_matrix(&a, path), 0);
+  ck_assert_int_eq(truncate(path, 64 + 35 * sizeof(double)), 0);
+  ck_assert_int_eq(s21_mmap_matrix(path, &mapped), 1);
+  remove(path);
+  ck_assert_int_eq(s21_mmap_matrix(path, &mapped), 1);
+  ck_assert_int_eq(s21_save_matrix(NULL, path), 1);
+  ck_assert_int_eq(s21_save_matrix(&a, "no_such_dir/matrix.bin"), 1);
+  // LCOV_EXCL_START
+  s21_remove_matrix(&a);
+  // LCOV_EXCL_STOP
+}
+END_TEST
+
+START_TEST(test_tiled_mult) {
+  const char *paths[3] = {"s21_test_a.bin", "s21_test_b.bin",
+                          "s21_test_c.bin"};
+  matrix_t a, b, c, expected;
+  s21_tiled_t ta, tb, tc;
+  s21_create_matrix_aligned(150, 130, &a);
+  s21_create_matrix(130, 170, &b);
+  for (int i = 0; i < 150; i++) {
+    for (int j = 0; j < 130; j++) {
+      a.matrix[i][j] = (i * 7 + j * 3) % 11 - 5;
+    }
+  }
+  for (int i = 0; i < 130; i++) {
+    for (int j = 0; j < 170; j++) {
+      b.matrix[i][j] = (i * 5 + j) % 9 - 4.5;
+    }
+  }
+  ck_assert_int_eq(s21_save_matrix(&a, paths[0]), 0);
+  ck_assert_int_eq(s21_save_matrix(&b, paths[1]), 0);
+  ck_assert_int_eq(s21_tiled_open(paths[0], &ta), 0);
+  ck_assert_int_eq(s21_tiled_open(paths[1], &tb), 0);
+  ck_assert_int_eq(ta.ld, a.ld);
+  ck_assert_int_eq(s21_tiled_create(paths[2], 150, 170, &tc), 0);
+  ck_assert_int_eq(s21_tiled_mult(&ta, &tb, &tc, 64), 0);
+  ck_assert_int_eq(s21_tiled_mult(&ta, &ta, &tc, 64), 2);
+  ck_assert_int_eq(s21_tiled_mult(&ta, &tb, &tc, 0), 1);
+  s21_tiled_close(&tc);
+  ck_assert_int_eq(s21_tiled_mult(&ta, &tb, &tc, 64), 1);
+  ck_assert_int_eq(s21_mmap_matrix(paths[2], &c), 0);
+  ck_assert_int_eq(s21_mult_matrix(&a, &b, &expected), 0);
+  ck_assert_int_eq(s21_eq_matrix(&c, &expected), SUCCESS);
+  s21_remove_matrix(&c);
+  // Tiles copied out and back in round-trip through the file.
+  s21_create_matrix(3, 4, &c);
+  ck_assert_int_eq(s21_tiled_read(&tb, 127, 166, &c), 0);
+  ck_assert_double_eq(c.matrix[2][3], b.matrix[129][169]);
+  c.matrix[0][0] = 42;
+  ck_assert_int_eq(s21_tiled_write(&tb, 127, 166, &c), 0);
+  ck_assert_int_eq(s21_tiled_read(&tb, 0, 0, &c), 0);
+  ck_assert_double_eq(c.matrix[1][2], b.matrix[1][2]);
+  ck_assert_int_eq(s21_tiled_read(&tb, 127, 166, &c), 0);
+  ck_assert_double_eq(c.matrix[0][0], 42);
+  ck_assert_int_eq(s21_tiled_read(&tb, 128, 0, &c), 2);
+  ck_assert_int_eq(s21_tiled_write(&tb, 0, -1, &c), 2);
+  ck_assert_int_eq(s21_tiled_read(&tb, 0, 0, NULL), 1);
+  s21_tiled_close(&ta);
+  s21_tiled_close(&tb);
+  ck_assert_int_eq(s21_tiled_open("no_such_file.bin", &ta), 1);
+  // A file too short for a header is closed and not left in fd.
+  FILE *short_file = fopen(paths[2], "w");
+  fputs("short", short_file);
+  fclose(short_file);
+  ck_assert_int_eq(s21_tiled_open(paths[2], &ta), 1);
+  ck_assert_int_eq(ta.fd, -1);
+  ck_assert_int_eq(s21_tiled_create("no_such_dir/c.bin", 2, 2, &ta), 1);
+  ck_assert_int_eq(s21_tiled_create(paths[2], 0, 2, &ta), 1);
+  for (int i = 0; i < 3; i++) {
+    remove(paths[i]);
+  }
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&c);
+  s21_remove_matrix(&expected);
+}
+END_TEST
+
+START_TEST(test_tiled_lu) {
+  const char *path = "s21_test_matrix.bin";
+  int n = 200, p[200], singular = 0;
+  double det = 0, expected = 0;
+  matrix_t a, lu;
+  s21_tiled_t ta;
+  s21_create_matrix(n, n, &a);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a.matrix[i][j] = ((i * 37 + j * 11) % 23 - 11) / 8.0 + (i + j == n) * 4;
+    }
+  }
+  ck_assert_int_eq(s21_save_matrix(&a, path), 0);
+  ck_assert_int_eq(s21_tiled_open(path, &ta), 0);
+  ck_assert_int_eq(s21_tiled_lu(&ta, 64, p, &singular), 0);
+  ck_assert_int_eq(singular, 0);
+  s21_tiled_close(&ta);
+  ck_assert_int_eq(s21_mmap_matrix(path, &lu), 0);
+  // P * A = L * U, and the determinant is the signed product of pivots.
+  double error = 0;
+  int *seen = calloc(n, sizeof(int)), sign = 1;
+  for (int i = 0; i < n; i++) {
+    seen[p[i]]++;
+    for (int j = 0; j < n; j++) {
+      double sum = i <= j ? lu.matrix[i][j] : 0;
+      for (int k = 0; k < i && k <= j; k++) {
+        sum += lu.matrix[i][k] * lu.matrix[k][j];
+      }
+      error = fmax(error, fabs(sum - a.matrix[p[i]][j]));
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    ck_assert_int_eq(seen[i], 1);
+    for (int j = i + 1; j < n; j++) {
+      sign = p[j] < p[i] ? -sign : sign;
+    }
+  }
+  free(seen);
+  ck_assert_double_le(error, 1e-9);
+  det = sign;
+  for (int i = 0; i < n; i++) {
+    det *= lu.matrix[i][i];
+  }
+  ck_assert_int_eq(s21_determinant(&a, &expected), 0);
+  ck_assert_double_eq_tol(det / expected, 1, 1e-9);
+  s21_remove_matrix(&lu);
+  for (int i = 0; i < n; i++) {
+    a.matrix[i][100] = 0;
+  }
+  ck_assert_int_eq(s21_save_matrix(&a, path), 0);
+  ck_assert_int_eq(s21_tiled_open(path, &ta), 0);
+  ck_assert_int_eq(s21_tiled_lu(&ta, 64, p, &singular), 0);
+  ck_assert_int_eq(singular, 1);
+  ck_assert_int_eq(s21_tiled_lu(&ta, 64, NULL, &singular), 1);
+  s21_tiled_close(&ta);
+  s21_remove_matrix(&a);
+  s21_create_matrix(3, 4, &a);
+  ck_assert_int_eq(s21_save_matrix(&a, path), 0);
+  ck_assert_int_eq(s21_tiled_open(path, &ta), 0);
+  ck_assert_int_eq(s21_tiled_lu(&ta, 64, p, &singular), 2);
+  s21_tiled_close(&ta);
+  remove(path);
+  s21_remove_matrix(&a);
+}
+END_TEST
+
+START_TEST(test_float) {
+  matrix_t a, b, prod, back;
+  matrix_f_t af, bf, rf, sf, tf;
+  s21_lu_f_t lu;
+  float det = 0;
+  ck_assert_int_eq(s21_create_matrix_f(0, 3, &af), 1);
+  ck_assert_int_eq(s21_to_float(NULL, &af), 1);
+  ck_assert_int_eq(s21_to_double(NULL, &a), 1);
+  // Small integers keep every product exact in float, at every SIMD level.
+  s21_create_matrix(150, 130, &a);
+  s21_create_matrix(130, 170, &b);
+  for (int i = 0; i < 150; i++) {
+    for (int j = 0; j < 130; j++) {
+      a.matrix[i][j] = (i * 7 + j * 3) % 11 - 5;
+      b.matrix[j][i % 170] = (j * 5 + i) % 9 - 4;
+    }
+  }
+  for (int j = 0; j < 130; j++) {
+    for (int i = 150; i < 170; i++) {
+      b.matrix[j][i] = (i + j) % 5 - 2;
+    }
+  }
+  ck_assert_int_eq(s21_to_float(&a, &af), 0);
+  ck_assert_int_eq(s21_to_float(&b, &bf), 0);
+  ck_assert_int_eq(s21_mult_matrix(&a, &b, &prod), 0);
+  for (int level = S21_SIMD_SCALAR; level <= S21_SIMD_AVX512; level += 3) {
+    s21_set_simd_level(level);
+    ck_assert_int_eq(s21_mult_matrix_f(&af, &bf, &rf), 0);
+    ck_assert_int_eq(s21_to_double(&rf, &back), 0);
+    ck_assert_int_eq(s21_eq_matrix(&back, &prod), SUCCESS);
+    s21_remove_matrix(&back);
+    s21_remove_matrix_f(&rf);
+  }
+  ck_assert_int_eq(s21_mult_matrix_f(&af, &af, &rf), 2);
+  ck_assert_int_eq(s21_sum_matrix_f(&af, &bf, &rf), 2);
+  ck_assert_int_eq(s21_eq_matrix_f(&af, &bf), FAILURE);
+  ck_assert_int_eq(s21_transpose_f(&bf, &tf), 0);
+  ck_assert_int_eq(s21_sum_matrix_f(&af, &af, &rf), 0);
+  ck_assert_int_eq(s21_sub_matrix_f(&rf, &af, &sf), 0);
+  ck_assert_int_eq(s21_eq_matrix_f(&sf, &af), SUCCESS);
+  s21_remove_matrix_f(&sf);
+  ck_assert_int_eq(s21_mult_number_f(&af, 2, &sf), 0);
+  ck_assert_int_eq(s21_eq_matrix_f(&sf, &rf), SUCCESS);
+  sf.matrix[149][129] += 1e-5f;
+  ck_assert_int_eq(s21_eq_matrix_f(&sf, &rf), FAILURE);
+  for (int i = 0; i < 130; i++) {
+    for (int j = 0; j < 170; j++) {
+      ck_assert_float_eq(tf.matrix[j][i], bf.matrix[i][j]);
+    }
+  }
+  s21_remove_matrix_f(&rf);
+  s21_remove_matrix_f(&sf);
+  s21_remove_matrix_f(&tf);
+  s21_remove_matrix_f(&af);
+  s21_remove_matrix_f(&bf);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&prod);
+  // The blocked LU and its solves, checked through A * A^-1 = I.
+  s21_create_matrix_f(150, 150, &af);
+  for (int i = 0; i < 150; i++) {
+    for (int j = 0; j < 150; j++) {
+      af.matrix[i][j] = ((i * 37 + j * 11) % 23 - 11) / 8.0f + (i + j == 150);
+    }
+  }
+  ck_assert_int_eq(s21_inverse_matrix_f(&af, &rf), 0);
+  ck_assert_int_eq(s21_mult_matrix_f(&af, &rf, &sf), 0);
+  for (int i = 0; i < 150; i++) {
+    for (int j = 0; j < 150; j++) {
+      ck_assert_float_eq_tol(sf.matrix[i][j], i == j, 1e-3);
+    }
+  }
+  s21_remove_matrix_f(&sf);
+  s21_create_matrix_f(150, 2, &bf);
+  bf.matrix[3][0] = 1;
+  bf.matrix[140][1] = -2;
+  ck_assert_int_eq(s21_solve_f(&af, &bf, &sf), 0);
+  for (int i = 0; i < 150; i++) {
+    ck_assert_float_eq_tol(sf.matrix[i][0], rf.matrix[i][3], 1e-3);
+    ck_assert_float_eq_tol(sf.matrix[i][1], -2 * rf.matrix[i][140], 1e-3);
+  }
+  s21_remove_matrix_f(&sf);
+  ck_assert_int_eq(s21_lu_factor_f(&af, &lu), 0);
+  ck_assert_int_eq(s21_lu_solve_f(&lu, &rf, &sf), 0);
+  ck_assert_int_eq(s21_lu_solve_f(NULL, &rf, &sf), 1);
+  s21_remove_matrix_f(&sf);
+  s21_remove_matrix_f(&rf);
+  s21_lu_remove_f(&lu);
+  ck_assert_int_eq(s21_lu_factor_f(&bf, &lu), 2);
+  ck_assert_int_eq(s21_lu_solve_f(&lu, &bf, &sf), 1);
+  for (int i = 0; i < 150; i++) {
+    af.matrix[i][100] = 0;
+  }
+  ck_assert_int_eq(s21_determinant_f(&af, &det), 0);
+  ck_assert_float_eq(det, 0);
+  ck_assert_int_eq(s21_inverse_matrix_f(&af, &rf), 2);
+  ck_assert_int_eq(s21_solve_f(&af, &bf, &sf), 2);
+  s21_remove_matrix_f(&af);
+  s21_remove_matrix_f(&bf);
+  // Orders below 4 against the double results.
+  s21_create_matrix_f(3, 3, &af);
+  float values[9] = {2, 5, 7, 6, 3, 4, 5, -2, -3};
+  for (int i = 0; i < 9; i++) {
+    af.matrix[i / 3][i % 3] = values[i];
+  }
+  ck_assert_int_eq(s21_determinant_f(&af, &det), 0);
+  ck_assert_float_eq_tol(det, -1, 1e-5);
+  ck_assert_int_eq(s21_determinant_f(&af, NULL), 1);
+  ck_assert_int_eq(s21_calc_complements_f(&af, &rf), 0);
+  ck_assert_float_eq_tol(rf.matrix[0][0], -1, 1e-5);
+  ck_assert_float_eq_tol(rf.matrix[1][2], 29, 1e-5);
+  ck_assert_float_eq_tol(rf.matrix[2][1], 34, 1e-5);
+  s21_remove_matrix_f(&rf);
+  ck_assert_int_eq(s21_calc_complements_f(NULL, &rf), 1);
+  s21_remove_matrix_f(&af);
+}
+END_TEST
+
+START_TEST(test_solve_mixed) {
+  int n = 200;
+  matrix_t a, b, x, expected;
+  s21_create_matrix(n, n, &a);
+  s21_create_matrix(n, 3, &b);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a.matrix[i][j] = ((i * 37 + j * 11) % 23 - 11) / 8.0 + (i + j == n) * 4;
+    }
+    b.matrix[i][0] = i % 7 - 3;
+    b.matrix[i][1] = 1.0 / (i + 1);
+  }
+  // Refined until the residual meets the solver's bound; the solution then
+  // agrees with the double one up to the conditioning of A.
+  matrix_t ax, r;
+  double norm = 0;
+  ck_assert_int_eq(s21_solve_mixed(&a, &b, &x), 0);
+  ck_assert_int_eq(s21_solve(&a, &b, &expected), 0);
+  ck_assert_int_eq(s21_mult_matrix(&a, &x, &ax), 0);
+  ck_assert_int_eq(s21_sub_matrix(&b, &ax, &r), 0);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      norm += a.matrix[i][j] * a.matrix[i][j];
+    }
+  }
+  ck_assert_int_eq(is_refined(&r, &x, sqrt(norm) * DBL_EPSILON * sqrt(n)), 1);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < 3; j++) {
+      ck_assert_double_eq_tol(x.matrix[i][j], expected.matrix[i][j], 1e-9);
+    }
+  }
+  s21_remove_matrix(&ax);
+  s21_remove_matrix(&r);
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&expected);
+  ck_assert_int_eq(s21_solve_mixed(&a, &a, &x), 0);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      ck_assert_double_eq_tol(x.matrix[i][j], i == j, 1e-12);
+    }
+  }
+  s21_remove_matrix(&x);
+  ck_assert_int_eq(s21_solve_mixed(&b, &b, &x), 2);
+  ck_assert_int_eq(s21_solve_mixed(&a, NULL, &x), 1);
+  for (int i = 0; i < n; i++) {
+    a.matrix[i][100] = 0;
+  }
+  ck_assert_int_eq(s21_solve_mixed(&a, &b, &x), 2);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  // Hilbert matrices are beyond float from order 8: the solve falls back
+  // to the double factorization.
+  s21_create_matrix(10, 10, &a);
+  s21_create_matrix(10, 1, &b);
+  for (int i = 0; i < 10; i++) {
+    for (int j = 0; j < 10; j++) {
+      a.matrix[i][j] = 1.0 / (i + j + 1);
+    }
+    b.matrix[i][0] = 1;
+  }
+  ck_assert_int_eq(s21_solve_mixed(&a, &b, &x), 0);
+  ck_assert_int_eq(s21_solve(&a, &b, &expected), 0);
+  for (int i = 0; i < 10; i++) {
+    ck_assert_double_eq(x.matrix[i][0], expected.matrix[i][0]);
+  }
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&expected);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  // Singular only in float: the fallback gets result untouched, so an
+  // uninitialized one is fine, and the call counts once.
+  matrix_t fresh;
+  s21_stats_t stats;
+  memset(&fresh, 0xAB, sizeof(fresh));
+  s21_create_matrix(2, 2, &a);
+  s21_create_matrix(2, 1, &b);
+  a.matrix[0][0] = a.matrix[0][1] = a.matrix[1][0] = 1;
+  a.matrix[1][1] = 1 + 1e-12;
+  b.matrix[0][0] = 2;
+  b.matrix[1][0] = 2 + 1e-12;
+  s21_stats_reset();
+  ck_assert_int_eq(s21_solve_mixed(&a, &b, &fresh), 0);
+  ck_assert_double_eq_tol(fresh.matrix[0][0], 1, 1e-2);
+  ck_assert_double_eq_tol(fresh.matrix[1][0], 1, 1e-2);
+  s21_stats_get(S21_STAT_SOLVE_MIXED, &stats);
+  ck_assert_int_eq(stats.calls, s21_stats_enabled());
+  s21_stats_get(S21_STAT_SOLVE, &stats);
+  ck_assert_int_eq(stats.calls, s21_stats_enabled());
+  s21_remove_matrix(&fresh);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  // A residual that is NaN in one row is not refined, whatever follows.
+  s21_create_matrix(2, 1, &a);
+  s21_create_matrix(2, 1, &b);
+  a.matrix[0][0] = NAN;
+  a.matrix[1][0] = 0.5;
+  b.matrix[0][0] = b.matrix[1][0] = 1;
+  ck_assert_int_eq(is_refined(&a, &b, 1), 0);
+  a.matrix[0][0] = 0.5;
+  ck_assert_int_eq(is_refined(&a, &b, 1), 1);
+  b.matrix[1][0] = INFINITY;
+  ck_assert_int_eq(is_refined(&a, &b, 1), 0);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  // So an X with NaN in some rows falls back to the double solve.
+  s21_create_matrix(2, 2, &a);
+  s21_create_matrix(2, 1, &b);
+  a.matrix[0][0] = 1;
+  a.matrix[1][1] = 3;
+  b.matrix[0][0] = NAN;
+  b.matrix[1][0] = 1;
+  s21_stats_reset();
+  ck_assert_int_eq(s21_solve_mixed(&a, &b, &x), 0);
+  ck_assert(isnan(x.matrix[0][0]));
+  ck_assert_double_eq_tol(x.matrix[1][0], 1.0 / 3, 1e-15);
+  s21_stats_get(S21_STAT_SOLVE, &stats);
+  ck_assert_int_eq(stats.calls, s21_stats_enabled());
+  s21_remove_matrix(&x);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+}
+END_TEST
+
+START_TEST(test_gemm_axpby) {
+  matrix_t a, b, c, d, prod, scaled, expected;
+  s21_create_matrix(150, 130, &a);
+  s21_create_matrix(130, 170, &b);
+  s21_create_matrix(150, 170, &d);
+  for (int i = 0; i < 150; i++) {
+    for (int j = 0; j < 130; j++) {
+      a.matrix[i][j] = (i * 7 + j * 3) % 11 - 5;
+    }
+    for (int j = 0; j < 170; j++) {
+      d.matrix[i][j] = (i + j * 5) % 13 - 6;
+    }
+  }
+  for (int i = 0; i < 130; i++) {
+    for (int j = 0; j < 170; j++) {
+      b.matrix[i][j] = (i * 5 + j) % 9 - 4;
+    }
+  }
+  // 2 * A * B - 3 * D, against the separate calls.
+  s21_mult_matrix(&a, &b, &prod);
+  s21_mult_number(&prod, 2, &scaled);
+  s21_remove_matrix(&prod);
+  s21_mult_number(&d, -3, &prod);
+  s21_sum_matrix(&scaled, &prod, &expected);
+  for (int level = S21_SIMD_SCALAR; level <= S21_SIMD_AVX512; level++) {
+    s21_set_simd_level(level);
+    s21_create_matrix(150, 170, &c);
+    ck_assert_int_eq(s21_axpby(1, &d, 0, &c), 0);
+    ck_assert_int_eq(s21_gemm(2, &a, &b, -3, &c), 0);
+    ck_assert_int_eq(s21_eq_matrix(&c, &expected), SUCCESS);
+    // beta = 0 never reads C, so NaN there does not leak through.
+    c.matrix[0][0] = NAN;
+    c.matrix[149][169] = NAN;
+    ck_assert_int_eq(s21_gemm(2, &a, &b, 0, &c), 0);
+    ck_assert_int_eq(s21_eq_matrix(&c, &scaled), SUCCESS);
+    // C = 2 * A * B - 3 * D as gemm followed by axpby.
+    ck_assert_int_eq(s21_axpby(-3, &d, 1, &c), 0);
+    ck_assert_int_eq(s21_eq_matrix(&c, &expected), SUCCESS);
+    c.matrix[7][9] = NAN;
+    ck_assert_int_eq(s21_axpby(1, &d, 0, &c), 0);
+    ck_assert_int_eq(s21_eq_matrix(&c, &d), SUCCESS);
+    s21_remove_matrix(&c);
+  }
+  s21_remove_matrix(&expected);
+  s21_remove_matrix(&scaled);
+  // alpha = 0 only scales C; X may be Y.
+  s21_create_matrix(150, 170, &c);
+  s21_axpby(1, &d, 0, &c);
+  ck_assert_int_eq(s21_gemm(0, &a, &b, -3, &c), 0);
+  ck_assert_int_eq(s21_eq_matrix(&c, &prod), SUCCESS);
+  ck_assert_int_eq(s21_axpby(1, &c, 1, &c), 0);
+  ck_assert_int_eq(s21_mult_number(&d, -6, &scaled), 0);
+  ck_assert_int_eq(s21_eq_matrix(&c, &scaled), SUCCESS);
+  ck_assert_int_eq(s21_gemm(0, &a, &b, 0, &c), 0);
+  ck_assert_double_eq(c.matrix[149][169], 0);
+  // Errors.
+  ck_assert_int_eq(s21_gemm(1, &a, &a, 1, &c), 2);
+  ck_assert_int_eq(s21_gemm(1, &b, &a, 1, &c), 2);
+  ck_assert_int_eq(s21_gemm(1, &a, &b, 1, &a), 2);
+  ck_assert_int_eq(s21_gemm(1, &a, &b, 1, NULL), 1);
+  ck_assert_int_eq(s21_axpby(1, &a, 1, &c), 2);
+  ck_assert_int_eq(s21_axpby(1, NULL, 1, &c), 1);
+  s21_remove_matrix(&c);
+  s21_create_matrix(150, 150, &c);
+  ck_assert_int_eq(s21_gemm(1, &c, &c, 1, &c), 2);
+  s21_remove_matrix(&c);
+  s21_remove_matrix(&scaled);
+  s21_remove_matrix(&prod);
+  s21_remove_matrix(&a);
+  s21_remove_matrix(&b);
+  s21_remove_matrix(&d);
+}
+END_TEST
+
 Suite *string_suite(void) {
   Suite *suite = suite_create("Matrix");
   TCase *tcase = tcase_create("matrix_functions");
@@ -403,6 +2210,24 @@ Suite *string_suite(void) {
   tcase_add_test(tcase, test_mult_number);
 
   tcase_add_test(tcase, test_mult_matrix);
+  tcase_add_test(tcase, test_mult_matrix_rect);
+  tcase_add_test(tcase, test_mult_matrix_large);
+
+  tcase_add_test(tcase, test_into);
+  tcase_add_test(tcase, test_into_bad);
+  tcase_add_test(tcase, test_inplace);
+  tcase_add_test(tcase, test_allocator);
+  tcase_add_test(tcase, test_arena);
+  tcase_add_test(tcase, test_create_aligned);
+  tcase_add_test(tcase, test_transpose_tiled);
+  tcase_add_test(tcase, test_stats);
+  tcase_add_test(tcase, test_view);
+  tcase_add_test(tcase, test_view_mult_large);
+  tcase_add_test(tcase, test_batch);
+  tcase_add_test(tcase, test_batch_arena);
+  tcase_add_test(tcase, test_batch_mult);
+  tcase_add_test(tcase, test_small_fixed);
+  tcase_add_test(tcase, test_fast);
 
   tcase_add_test(tcase, test_transpose);
 
@@ -420,8 +2245,35 @@ Suite *string_suite(void) {
   tcase_add_test(tcase, test_determinant_1x1_zero);
 
   tcase_add_test(tcase, test_calc_complements);
+  tcase_add_test(tcase, test_complements_adjugate);
 
   tcase_add_test(tcase, test_inverse);
+  tcase_add_test(tcase, test_inverse_pivot);
+  tcase_add_test(tcase, test_inverse_1x1);
+  tcase_add_test(tcase, test_inverse_singular);
+  tcase_add_test(tcase, test_inverse_not_square);
+
+  tcase_add_test(tcase, test_lu_solve);
+  tcase_add_test(tcase, test_lu_det_inverse);
+  tcase_add_test(tcase, test_lu_singular);
+  tcase_add_test(tcase, test_lu_inplace);
+  tcase_add_test(tcase, test_lu_bad);
+  tcase_add_test(tcase, test_lu_blocked);
+  tcase_add_test(tcase, test_solve);
+  tcase_add_test(tcase, test_cholesky);
+  tcase_add_test(tcase, test_float);
+  tcase_add_test(tcase, test_solve_mixed);
+  tcase_add_test(tcase, test_sparse);
+  tcase_add_test(tcase, test_sparse_lu);
+  tcase_add_test(tcase, test_mmap_matrix);
+  tcase_add_test(tcase, test_tiled_mult);
+  tcase_add_test(tcase, test_tiled_lu);
+  tcase_add_test(tcase, test_gemm_axpby);
+
+  tcase_add_test(tcase, test_num_threads);
+  tcase_add_test(tcase, test_parallel_ops);
+
+  tcase_add_test(tcase, test_simd_levels);
 
   suite_add_tcase(suite, tcase);
 